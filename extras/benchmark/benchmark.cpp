@@ -0,0 +1,202 @@
+/*
+  NAME:
+  Benchmark of the application library gbj_appsmooth on a host.
+
+  DESCRIPTION:
+  The program measures the throughput of the method setValue() for the
+  combinations of the data type of measures, storage layout, built-in
+  smoother, number of measures, and ratio of rejected input values.
+  - Input values are generated in advance, so that just the library is timed.
+    Rejected values exceed the maximum of valid range.
+  - The number of processed samples per case is the argument of the program
+    and it is rounded up to whole frames of all measures.
+  - Results are written to the standard output in JSON format for tracking of
+    performance regressions.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_appsmooth.git
+*/
+#include "gbj_appsmooth.h"
+#include "gbj_appsmooth_exponential.h"
+#include "gbj_appsmooth_running.h"
+#include <chrono>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace
+{
+  const unsigned long SAMPLES_DEF = 1UL << 22;
+  const unsigned int MEASURES_LIST[] = { 1, 8, 64, 1024, 4096 };
+  const float REJECT_LIST[] = { 0.0, 0.1, 0.5 };
+  // Pool of input values of prime size unrelated to numbers of measures
+  const unsigned int POOL = 1021;
+  const int VALID_MAX = 200;
+  const int VALID_RANGE = 100;
+  const int INVALID_VALUE = 1000;
+
+  unsigned long samples = SAMPLES_DEF;
+  bool flFirst = true;
+
+  template<typename DAT>
+  struct Type;
+  template<>
+  struct Type<float>
+  {
+    static const char *name() { return "float"; }
+  };
+  template<>
+  struct Type<double>
+  {
+    static const char *name() { return "double"; }
+  };
+  template<>
+  struct Type<int>
+  {
+    static const char *name() { return "int"; }
+  };
+
+  template<class LAY>
+  struct Layout;
+  template<>
+  struct Layout<gbj_appsmooth_aos>
+  {
+    static const char *name() { return "aos"; }
+  };
+  template<>
+  struct Layout<gbj_appsmooth_soa>
+  {
+    static const char *name() { return "soa"; }
+  };
+
+  template<class SMT>
+  struct Smoother;
+  template<>
+  struct Smoother<gbj_appsmooth_exponential>
+  {
+    static const char *name() { return "exponential"; }
+  };
+  template<unsigned int W, typename T>
+  struct Smoother<gbj_appsmooth_running<W, T>>
+  {
+    static const char *name() { return "running"; }
+  };
+
+  // Deterministic pseudo-random input values with the ratio of rejected ones
+  template<typename DAT>
+  void generate(DAT *pool, float reject)
+  {
+    uint32_t seed = 12345;
+    for (unsigned int k = 0; k < POOL; k++)
+    {
+      seed = seed * 1664525 + 1013904223;
+      bool flReject = (seed >> 8) % 1000 < (uint32_t)(reject * 1000);
+      seed = seed * 1664525 + 1013904223;
+      pool[k] =
+        flReject ? (DAT)INVALID_VALUE : (DAT)((seed >> 8) % VALID_RANGE);
+    }
+  }
+
+  template<class SMT, typename DAT, class LAY>
+  void measure(unsigned int measures, float reject)
+  {
+    typedef gbj_appsmooth<SMT, DAT, LAY, unsigned int> Smooth;
+    DAT pool[POOL];
+    generate(pool, reject);
+    Smooth *smooth = new Smooth();
+    smooth->begin(measures);
+    smooth->setMaximum((DAT)VALID_MAX);
+    unsigned long frames = (samples + measures - 1) / measures;
+    unsigned long accepted = 0;
+    unsigned int pos = 0;
+    std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+    for (unsigned long j = 0; j < frames; j++)
+    {
+      for (unsigned int i = 0; i < measures; i++)
+      {
+        accepted += smooth->setValue(pool[pos], i);
+        pos = pos + 1 < POOL ? pos + 1 : 0;
+      }
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    unsigned long count = frames * measures;
+    // The smoothed value keeps the loop from being optimized out
+    double check = (double)smooth->getValue(measures - 1);
+    delete smooth;
+    printf("%s\n    {\"smoother\": \"%s\", \"dat\": \"%s\", \"layout\": \"%s\", "
+           "\"measures\": %u, \"reject\": %.2f, \"samples\": %lu, "
+           "\"accepted\": %lu, \"ns_per_sample\": %.3f, "
+           "\"samples_per_s\": %.0f, \"check\": %.3f}",
+           flFirst ? "" : ",",
+           Smoother<SMT>::name(),
+           Type<DAT>::name(),
+           Layout<LAY>::name(),
+           measures,
+           reject,
+           count,
+           accepted,
+           elapsed / count,
+           count / elapsed * 1e9,
+           check);
+    flFirst = false;
+  }
+
+  template<class SMT, typename DAT, class LAY>
+  void sweep()
+  {
+    for (unsigned int measures : MEASURES_LIST)
+    {
+      for (float reject : REJECT_LIST)
+      {
+        measure<SMT, DAT, LAY>(measures, reject);
+      }
+    }
+  }
+
+  template<class SMT, typename DAT>
+  void sweep()
+  {
+    sweep<SMT, DAT, gbj_appsmooth_aos>();
+    sweep<SMT, DAT, gbj_appsmooth_soa>();
+  }
+
+  template<class SMT>
+  void sweep()
+  {
+    sweep<SMT, float>();
+    sweep<SMT, double>();
+    sweep<SMT, int>();
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc > 1)
+  {
+    samples = strtoul(argv[1], NULL, 10);
+    samples = samples ? samples : 1;
+  }
+  printf("{\n  \"library\": \"gbj_appsmooth\",\n  \"compiler\": \"%s\",\n"
+         "  \"simd\": \"%s\",\n  \"results\": [",
+         __VERSION__,
+#if defined(__AVX2__)
+         "avx2"
+#elif defined(__SSE2__)
+         "sse2"
+#else
+         "none"
+#endif
+  );
+  sweep<gbj_appsmooth_exponential>();
+  sweep<gbj_appsmooth_running<5>>();
+  printf("\n  ]\n}\n");
+  return 0;
+}
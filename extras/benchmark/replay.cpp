@@ -0,0 +1,156 @@
+/*
+  NAME:
+  Test of the offline replay of the application library gbj_appsmooth.
+
+  DESCRIPTION:
+  The program replays the same recorded frames from a CSV file and from
+  a binary file and compares the results.
+  - Frames contain samples out of the valid range and exceeding the valid
+    difference, so that results contain both valid and invalid measures.
+  - The number of measures is not a multiple of 8, so that bitmasks of
+    binary results contain padding bits, which should be cleared.
+  - The chunk is small, so that the binary replay streams several chunks
+    with an incomplete last one.
+  - The program returns nonzero exit code at the first mismatch.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_appsmooth.git
+*/
+#define GBJ_APPSMOOTH_REPLAY_CHUNK 256
+#include "gbj_appsmooth.h"
+#include "gbj_appsmooth_exponential.h"
+#include "gbj_appsmooth_replay.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace
+{
+  typedef gbj_appsmooth<gbj_appsmooth_exponential, float, gbj_appsmooth_soa>
+    Smooth;
+  typedef gbj_appsmooth_replay<Smooth> Replay;
+
+  const unsigned int MEASURES = 11;
+  const unsigned int FRAMES = 50;
+  const unsigned int BYTES = (MEASURES + 7) / 8;
+  const float MINIMUM = 10.0;
+  const float MAXIMUM = 90.0;
+  const float DIFFERENCE = 30.0;
+
+  void setup(Smooth &smooth)
+  {
+    smooth.begin(MEASURES);
+    smooth.setMinimum(MINIMUM);
+    smooth.setMaximum(MAXIMUM);
+    smooth.setDifference(DIFFERENCE);
+  }
+
+  int fail(const char *what, unsigned int frame, unsigned int idx)
+  {
+    fprintf(stderr, "Mismatch of %s at frame %u, measure %u\n", what, frame,
+            idx);
+    return 1;
+  }
+}
+
+int main()
+{
+  Smooth smoothCsv, smoothBin;
+  setup(smoothCsv);
+  setup(smoothBin);
+  FILE *csvIn = tmpfile();
+  FILE *csvOut = tmpfile();
+  FILE *binIn = tmpfile();
+  FILE *binOut = tmpfile();
+  if (!(csvIn && csvOut && binIn && binOut))
+  {
+    fprintf(stderr, "Temporary files not available\n");
+    return 1;
+  }
+  // Recording of the same deterministic pseudo-random frames in both formats
+  uint32_t seed = 12345;
+  for (unsigned int i = 0; i < MEASURES; i++)
+  {
+    fprintf(csvIn, "%sm%u", i ? "," : "", i);
+  }
+  fputc('\n', csvIn);
+  for (unsigned int j = 0; j < FRAMES; j++)
+  {
+    float frame[MEASURES];
+    for (unsigned int i = 0; i < MEASURES; i++)
+    {
+      seed = seed * 1664525 + 1013904223;
+      frame[i] = (float)((seed >> 8) % 1000) / 10.0f;
+      fprintf(csvIn, "%s%.9g", i ? "," : "", (double)frame[i]);
+    }
+    fputc('\n', csvIn);
+    fwrite(frame, sizeof(frame), 1, binIn);
+  }
+  rewind(csvIn);
+  rewind(binIn);
+  // Replay
+  if (Replay::csv(smoothCsv, csvIn, csvOut) != FRAMES)
+  {
+    return fail("CSV frames", FRAMES, 0);
+  }
+  if (Replay::binary(smoothBin, binIn, binOut) != FRAMES)
+  {
+    return fail("binary frames", FRAMES, 0);
+  }
+  rewind(csvOut);
+  rewind(binOut);
+  // Comparison of results
+  char line[1024];
+  if (!fgets(line, sizeof(line), csvOut))
+  {
+    return fail("CSV header", 0, 0);
+  }
+  unsigned int valid[2] = { 0, 0 };
+  for (unsigned int j = 0; j < FRAMES; j++)
+  {
+    byte result[MEASURES * sizeof(float) + BYTES];
+    if (!fgets(line, sizeof(line), csvOut) ||
+        fread(result, sizeof(result), 1, binOut) != 1)
+    {
+      return fail("number of frames", j, 0);
+    }
+    const byte *mask = result + MEASURES * sizeof(float);
+    char *pos = line;
+    for (unsigned int i = 0; i < MEASURES; i++)
+    {
+      char *end;
+      float valueCsv = strtof(pos, &end);
+      int validCsv = (int)strtol(end + 1, &pos, 10);
+      pos++;
+      float valueBin;
+      memcpy(&valueBin, result + i * sizeof(float), sizeof(float));
+      int validBin = (mask[i >> 3] >> (i & 7)) & 1;
+      if (valueCsv != valueBin)
+      {
+        return fail("values", j, i);
+      }
+      if (validCsv != validBin)
+      {
+        return fail("validity", j, i);
+      }
+      valid[validBin]++;
+    }
+    if (mask[BYTES - 1] >> (MEASURES & 7))
+    {
+      return fail("padding bits", j, MEASURES);
+    }
+  }
+  if (!(valid[0] && valid[1]))
+  {
+    return fail("mix of valid and invalid measures", FRAMES, 0);
+  }
+  printf("Replayed %u frames of %u measures, %u valid and %u invalid "
+         "samples\n",
+         FRAMES, MEASURES, valid[1], valid[0]);
+  return 0;
+}
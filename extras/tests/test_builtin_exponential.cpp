@@ -0,0 +1,844 @@
+/*
+  NAME:
+  Unit tests of application library "gbj_appsmoothing" for smoothing
+  with the built-in exponential filtering "gbj_appsmooth_exponential".
+
+  DESCRIPTION:
+  The test file provides test cases for smoothing measures of various data
+  types and compares results with the generic library "gbj_exponential",
+  which should be identical.
+  - The test runner is Unity Project - ThrowTheSwitch.org.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#define SERIAL_NODEBUG
+#include "gbj_appsmooth.h"
+#include "gbj_appsmooth_exponential.h"
+#include "gbj_appsmooth_qformat.h"
+#include "gbj_appsmooth_queue.h"
+#include "gbj_appsmooth_sweep.h"
+#include "gbj_exponential.h"
+#include <Arduino.h>
+#include <unity.h>
+
+//******************************************************************************
+// Preparation
+//******************************************************************************
+const float EXPONENTIAL_FACTOR = 0.2;
+const float MINIMUM = 40.0;
+const float MAXIMUM = 60.0;
+const float DIFFERENCE = 10.0;
+const byte MEASURES = 10;
+const unsigned long INTERVAL = 10;
+const float TOLERANCE = 0.01;
+// Measures of a frame spanning several shards with an incomplete flag byte
+const byte FRAME = 50;
+
+const float SAMPLE_LIST[] = { 42.3, 38.9, 45.0, 56.7, 61.7, 52.3, 41.1, 48.4 };
+const byte SAMPLES = sizeof(SAMPLE_LIST) / sizeof(SAMPLE_LIST[0]);
+const unsigned long TIMESTAMP_LIST[] = { 0, 10, 15, 40, 50, 95, 100, 103 };
+// Step of a signal exceeding the valid difference
+const byte RECOVERY = 3;
+const float STEP_LIST[] = { 42, 43, 41, 55, 56, 54, 55, 44, 56, 55, 54 };
+const bool STEP_VALID_LIST[] = { 1, 1, 1, 0, 0, 1, 1, 0, 1, 1, 1 };
+const byte STEPS = sizeof(STEP_LIST) / sizeof(STEP_LIST[0]);
+
+gbj_appsmooth<gbj_exponential, float> smoothGeneric =
+  gbj_appsmooth<gbj_exponential, float>();
+
+gbj_appsmooth<gbj_appsmooth_exponential, float> smoothFloat =
+  gbj_appsmooth<gbj_appsmooth_exponential, float>();
+
+gbj_appsmooth<gbj_appsmooth_exponential, float, gbj_appsmooth_soa> smoothSoa =
+  gbj_appsmooth<gbj_appsmooth_exponential, float, gbj_appsmooth_soa>();
+
+#if !defined(__AVR__)
+// Measures beyond byte indices, which do not fit memory of AVR platforms
+const uint16_t WIDE = 300;
+typedef gbj_appsmooth<gbj_appsmooth_exponential,
+                      float,
+                      gbj_appsmooth_aos,
+                      uint16_t>
+  WideAos;
+typedef gbj_appsmooth<gbj_appsmooth_exponential,
+                      float,
+                      gbj_appsmooth_soa,
+                      uint16_t>
+  WideSoa;
+WideAos smoothWide = WideAos();
+WideSoa smoothWideSoa = WideSoa();
+
+gbj_appsmooth<gbj_appsmooth_exponential, float, gbj_appsmooth_concurrent>
+  smoothConcurrent =
+    gbj_appsmooth<gbj_appsmooth_exponential, float, gbj_appsmooth_concurrent>();
+#endif
+
+typedef gbj_appsmooth_qexponential<gbj_appsmooth_q16_16> Q16;
+// Short type with range for all samples of all measures
+typedef gbj_appsmooth_q<int16_t, 4> gbj_appsmooth_q12_4;
+typedef gbj_appsmooth_qexponential<gbj_appsmooth_q12_4> Q12;
+gbj_appsmooth<Q16, gbj_appsmooth_q16_16, gbj_appsmooth_soa> smoothQ16 =
+  gbj_appsmooth<Q16, gbj_appsmooth_q16_16, gbj_appsmooth_soa>();
+gbj_appsmooth<Q12, gbj_appsmooth_q12_4> smoothQ12 =
+  gbj_appsmooth<Q12, gbj_appsmooth_q12_4>();
+
+const unsigned int QUEUE = 16;
+gbj_appsmooth_queue<float, byte, QUEUE> queue;
+
+gbj_appsmooth_sweep<gbj_appsmooth_exponential> sweep =
+  gbj_appsmooth_sweep<gbj_appsmooth_exponential>();
+
+gbj_appsmooth<gbj_exponential, unsigned int> smoothGenericUint =
+  gbj_appsmooth<gbj_exponential, unsigned int>();
+
+gbj_appsmooth<gbj_appsmooth_exponential, unsigned int> smoothUint =
+  gbj_appsmooth<gbj_appsmooth_exponential, unsigned int>();
+
+template<class APP>
+void setup_range_difference(APP &smooth)
+{
+  smooth.begin(MEASURES);
+  for (byte i = 0; i < smooth.getMeasures(); i++)
+  {
+    smooth.getMeasurePtr(i)->setFactor(EXPONENTIAL_FACTOR);
+    smooth.setMinimum(MINIMUM * (i + 1), i);
+    smooth.setMaximum(MAXIMUM * (i + 1), i);
+    smooth.setDifference(DIFFERENCE * (i + 1), i);
+  }
+}
+
+template<class APP>
+void setup_norange(APP &smooth)
+{
+  smooth.begin(MEASURES);
+  for (byte i = 0; i < smooth.getMeasures(); i++)
+  {
+    smooth.getMeasurePtr(i)->setFactor(EXPONENTIAL_FACTOR);
+  }
+}
+
+template<class APP>
+void setup_frame(APP &smooth)
+{
+  smooth.begin(FRAME);
+  for (byte i = 0; i < smooth.getMeasures(); i++)
+  {
+    smooth.getMeasurePtr(i)->setFactor(EXPONENTIAL_FACTOR);
+    smooth.setMinimum(MINIMUM, i);
+    smooth.setMaximum(MAXIMUM, i);
+    smooth.setDifference(DIFFERENCE, i);
+  }
+}
+
+//******************************************************************************
+// Tests
+//******************************************************************************
+void test_factor_float(void)
+{
+  float valActual, valExpected;
+  setup_norange(smoothFloat);
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    valExpected = EXPONENTIAL_FACTOR;
+    valActual = smoothFloat.getMeasurePtr(i)->getFactor();
+    String msg = "i=" + String(i);
+    TEST_ASSERT_EQUAL_FLOAT_MESSAGE(valExpected, valActual, msg.c_str());
+  }
+}
+
+void test_float_range_difference(void)
+{
+  setup_range_difference(smoothGeneric);
+  setup_range_difference(smoothFloat);
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    for (byte j = 0; j < SAMPLES; j++)
+    {
+      float valInput = SAMPLE_LIST[j] * (i + 1);
+      // Testee
+      smoothGeneric.setValue(valInput, i);
+      smoothFloat.setValue(valInput, i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothGeneric.getValue(i) == smoothFloat.getValue(i), msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothGeneric.isValid(i) == smoothFloat.isValid(i), msg.c_str());
+    }
+  }
+}
+
+void test_soa_range_difference_values(void)
+{
+  float frame[MEASURES];
+  setup_range_difference(smoothGeneric);
+  setup_range_difference(smoothSoa);
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      frame[i] = SAMPLE_LIST[(i + j) % SAMPLES] * (i + 1);
+      smoothGeneric.setValue(frame[i], i);
+    }
+    // Testee
+    smoothSoa.setValues(frame);
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothGeneric.getValue(i) == smoothSoa.getValue(i), msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothGeneric.isValid(i) == smoothSoa.isValid(i), msg.c_str());
+    }
+  }
+}
+
+void test_soa_shards(void)
+{
+  float frame[FRAME];
+  byte validFrame[(FRAME + 7) / 8], validShards[(FRAME + 7) / 8];
+  setup_frame(smoothFloat);
+  setup_frame(smoothSoa);
+  byte shard = smoothSoa.getShard();
+  TEST_ASSERT_EQUAL_UINT8(0, shard % 8);
+  TEST_ASSERT_EQUAL_UINT32(0, shard * sizeof(float) % GBJ_APPSMOOTH_CACHE_LINE);
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    memset(validFrame, 0xA5, sizeof(validFrame));
+    memset(validShards, 0xA5, sizeof(validShards));
+    for (byte i = 0; i < FRAME; i++)
+    {
+      frame[i] = SAMPLE_LIST[(i + j) % SAMPLES];
+    }
+    byte accepted = smoothFloat.setValues(frame, validFrame);
+    // Testee
+    byte acceptedShards = 0;
+    for (byte first = 0; first < FRAME; first += shard)
+    {
+      acceptedShards += smoothSoa.setValues(frame, validShards, first, shard);
+    }
+    String msg = "j=" + String(j);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(accepted, acceptedShards, msg.c_str());
+    for (byte k = 0; k < sizeof(validFrame); k++)
+    {
+      msg = "j=" + String(j) + ", k=" + String(k);
+      TEST_ASSERT_EQUAL_UINT8_MESSAGE(
+        validFrame[k], validShards[k], msg.c_str());
+    }
+    for (byte i = 0; i < FRAME; i++)
+    {
+      msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothFloat.getValue(i) == smoothSoa.getValue(i), msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothFloat.isValid(i) == smoothSoa.isValid(i), msg.c_str());
+    }
+  }
+}
+
+#if !defined(__AVR__)
+void test_soa_frame(void)
+{
+  float frame[FRAME];
+  byte validFrame[(FRAME + 7) / 8], validShards[(FRAME + 7) / 8];
+  gbj_appsmooth<gbj_appsmooth_exponential, float, gbj_appsmooth_soa>::Frame
+    state;
+  setup_frame(smoothFloat);
+  setup_frame(smoothSoa);
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    memset(validFrame, 0xA5, sizeof(validFrame));
+    memset(validShards, 0xA5, sizeof(validShards));
+    for (byte i = 0; i < FRAME; i++)
+    {
+      frame[i] = SAMPLE_LIST[(i + j) % SAMPLES];
+    }
+    byte accepted = smoothFloat.setValues(frame, validFrame);
+    // Testee
+    smoothSoa.beginFrame(state, frame, validShards);
+    TEST_ASSERT_TRUE(smoothSoa.runFrame(state));
+    TEST_ASSERT_EQUAL_UINT8(accepted, smoothSoa.endFrame(state));
+    for (byte k = 0; k < sizeof(validFrame); k++)
+    {
+      String msg = "j=" + String(j) + ", k=" + String(k);
+      TEST_ASSERT_EQUAL_UINT8_MESSAGE(
+        validFrame[k], validShards[k], msg.c_str());
+    }
+    for (byte i = 0; i < FRAME; i++)
+    {
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothFloat.getValue(i) == smoothSoa.getValue(i), msg.c_str());
+    }
+  }
+}
+#endif
+
+#if !defined(__AVR__)
+template<class APP>
+void setup_wide(APP &smooth)
+{
+  smooth.begin(WIDE);
+  for (uint16_t i = 0; i < smooth.getMeasures(); i++)
+  {
+    smooth.getMeasurePtr(i)->setFactor(EXPONENTIAL_FACTOR);
+  }
+  smooth.setMinimum(MINIMUM);
+  smooth.setMaximum(MAXIMUM);
+  smooth.setDifference(DIFFERENCE);
+}
+
+void test_wide_index(void)
+{
+  float frame[WIDE];
+  byte valid[(WIDE + 7) / 8];
+  setup_wide(smoothWide);
+  setup_wide(smoothWideSoa);
+  TEST_ASSERT_EQUAL_UINT32(WIDE, smoothWide.getMeasures());
+  TEST_ASSERT_EQUAL_UINT32(WIDE, smoothWideSoa.getMeasures());
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    memset(valid, 0, sizeof(valid));
+    for (uint16_t i = 0; i < WIDE; i++)
+    {
+      frame[i] = SAMPLE_LIST[(i + j) % SAMPLES];
+      smoothWide.setValue(frame[i], i);
+    }
+    // Testee
+    uint16_t accepted = smoothWideSoa.setValues(frame, valid);
+    uint16_t acceptedExpected = 0;
+    for (uint16_t i = 0; i < WIDE; i++)
+    {
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      bool flValid = (valid[i / 8] >> (i % 8)) & 1;
+      acceptedExpected += smoothWide.isValid(i);
+      TEST_ASSERT_TRUE_MESSAGE(smoothWide.isValid(i) == flValid, msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(smoothWideSoa.isValid(i) == flValid,
+                               msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothWide.getValue(i) == smoothWideSoa.getValue(i), msg.c_str());
+    }
+    TEST_ASSERT_EQUAL_UINT32(acceptedExpected, accepted);
+  }
+  // Measures beyond byte indices do not alias measures wrapped to byte
+  smoothWide.setMaximum(0.0, WIDE - 1);
+  smoothWideSoa.setMaximum(0.0, 256);
+  TEST_ASSERT_EQUAL_FLOAT(MAXIMUM, smoothWide.getMaximum((WIDE - 1) % 256));
+  TEST_ASSERT_EQUAL_FLOAT(MAXIMUM, smoothWideSoa.getMaximum(0));
+  TEST_ASSERT_FALSE(smoothWide.setValue(MINIMUM, WIDE - 1));
+  TEST_ASSERT_FALSE(smoothWideSoa.setValue(MINIMUM, 256));
+  TEST_ASSERT_FALSE(smoothWide.isValid(WIDE - 1));
+  TEST_ASSERT_FALSE(smoothWideSoa.isValid(256));
+}
+#endif
+
+void test_soa_lazy(void)
+{
+  float frame[MEASURES];
+  setup_range_difference(smoothGeneric);
+  setup_range_difference(smoothSoa);
+  smoothSoa.setLazy(SAMPLES / 2);
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      frame[i] = SAMPLE_LIST[(i + j) % SAMPLES] * (i + 1);
+      smoothGeneric.setValue(frame[i], i);
+    }
+    smoothSoa.setValues(frame);
+  }
+  // Testee
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    String msg = "i=" + String(i);
+    TEST_ASSERT_TRUE_MESSAGE(
+      smoothGeneric.getValue(i) == smoothSoa.getValue(i), msg.c_str());
+    TEST_ASSERT_TRUE_MESSAGE(
+      smoothGeneric.isValid(i) == smoothSoa.isValid(i), msg.c_str());
+  }
+}
+
+#if !defined(__AVR__)
+void test_concurrent_range_difference(void)
+{
+  setup_range_difference(smoothFloat);
+  setup_range_difference(smoothConcurrent);
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      float valInput = SAMPLE_LIST[(i + j) % SAMPLES] * (i + 1);
+      // Testee
+      smoothFloat.setValue(valInput, i);
+      smoothConcurrent.setValue(valInput, i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothFloat.getValue(i) == smoothConcurrent.getValue(i), msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothFloat.isValid(i) == smoothConcurrent.isValid(i), msg.c_str());
+    }
+  }
+}
+
+void test_concurrent_snapshot(void)
+{
+  float valActual;
+  bool flActual;
+  setup_range_difference(smoothFloat);
+  setup_range_difference(smoothConcurrent);
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      float valInput = SAMPLE_LIST[(i + j) % SAMPLES] * (i + 1);
+      smoothFloat.setValue(valInput, i);
+      smoothConcurrent.setValue(valInput, i);
+    }
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      // Testee
+      flActual = smoothConcurrent.getSnapshot(valActual, i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_TRUE_MESSAGE(smoothFloat.getValue(i) == valActual,
+                               msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(smoothFloat.isValid(i) == flActual,
+                               msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(smoothConcurrent.getValue(i) == valActual,
+                               msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(smoothConcurrent.isValid(i) == flActual,
+                               msg.c_str());
+    }
+  }
+}
+#endif
+
+void test_queue_full_empty(void)
+{
+  queue.release(queue.available());
+  TEST_ASSERT_TRUE(queue.isEmpty());
+  TEST_ASSERT_EQUAL_UINT32(0, queue.available());
+  for (unsigned int k = 0; k < QUEUE; k++)
+  {
+    String msg = "k=" + String(k);
+    TEST_ASSERT_TRUE_MESSAGE(queue.push(SAMPLE_LIST[k % SAMPLES], 0),
+                             msg.c_str());
+  }
+  // Testee
+  TEST_ASSERT_FALSE(queue.push(SAMPLE_LIST[0], 0));
+  TEST_ASSERT_FALSE(queue.isEmpty());
+  TEST_ASSERT_EQUAL_UINT32(QUEUE, queue.available());
+  queue.release(queue.available());
+  TEST_ASSERT_TRUE(queue.isEmpty());
+  TEST_ASSERT_TRUE(queue.push(SAMPLE_LIST[0], 0));
+  queue.release(queue.available());
+}
+
+void test_queue_wraparound(void)
+{
+  const unsigned int BATCH = QUEUE / 2 + 1;
+  unsigned int pushed = 0, popped = 0;
+  queue.release(queue.available());
+  // Positions pass the capacity several times with batches misaligned to it
+  for (byte r = 0; r < 5; r++)
+  {
+    for (unsigned int k = 0; k < BATCH; k++, pushed++)
+    {
+      queue.push(SAMPLE_LIST[pushed % SAMPLES], pushed % MEASURES, pushed);
+    }
+    TEST_ASSERT_EQUAL_UINT32(BATCH, queue.available());
+    // Testee
+    for (unsigned int k = 0; k < BATCH; k++, popped++)
+    {
+      const gbj_appsmooth_queue<float, byte, QUEUE>::Sample &sample =
+        queue.peek(k);
+      String msg = "r=" + String(r) + ", k=" + String(k);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+        SAMPLE_LIST[popped % SAMPLES], sample.value, msg.c_str());
+      TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+        popped % MEASURES, sample.idx, msg.c_str());
+      TEST_ASSERT_EQUAL_UINT32_MESSAGE(popped, sample.timestamp, msg.c_str());
+    }
+    queue.release(BATCH);
+    TEST_ASSERT_TRUE(queue.isEmpty());
+  }
+}
+
+void test_queue_drain(void)
+{
+  const unsigned int LIMIT = 4;
+  setup_range_difference(smoothFloat);
+  setup_range_difference(smoothSoa);
+  queue.release(queue.available());
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      float valInput = SAMPLE_LIST[(i + j) % SAMPLES] * (i + 1);
+      smoothFloat.setValue(valInput, i);
+      queue.push(valInput, i);
+    }
+    // Sample of a measure out of range is ignored
+    queue.push(SAMPLE_LIST[j], MEASURES);
+    // Testee
+    unsigned int count = smoothSoa.drain(queue, LIMIT);
+    TEST_ASSERT_EQUAL_UINT32(LIMIT, count);
+    count += smoothSoa.drain(queue);
+    TEST_ASSERT_EQUAL_UINT32(MEASURES + 1, count);
+    TEST_ASSERT_TRUE(queue.isEmpty());
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothFloat.getValue(i) == smoothSoa.getValue(i), msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothFloat.isValid(i) == smoothSoa.isValid(i), msg.c_str());
+    }
+  }
+}
+
+void test_recovery(void)
+{
+  float frame[MEASURES];
+  setup_range_difference(smoothFloat);
+  setup_range_difference(smoothSoa);
+  smoothFloat.setRecovery(RECOVERY);
+  smoothSoa.setRecovery(RECOVERY);
+  float valExpected = STEP_LIST[0];
+  for (byte j = 0; j < STEPS; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      frame[i] = STEP_LIST[j] * (i + 1);
+      smoothFloat.setValue(frame[i], i);
+    }
+    smoothSoa.setValues(frame);
+    // Algorithm
+    if (STEP_VALID_LIST[j])
+    {
+      valExpected += EXPONENTIAL_FACTOR * (STEP_LIST[j] - valExpected);
+    }
+    // Testee
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_TRUE_MESSAGE(
+        STEP_VALID_LIST[j] == smoothFloat.isValid(i), msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(
+        STEP_VALID_LIST[j] == smoothSoa.isValid(i), msg.c_str());
+      TEST_ASSERT_FLOAT_WITHIN_MESSAGE(TOLERANCE * (i + 1),
+                                       valExpected * (i + 1),
+                                       smoothFloat.getValue(i),
+                                       msg.c_str());
+      TEST_ASSERT_FLOAT_WITHIN_MESSAGE(TOLERANCE * (i + 1),
+                                       valExpected * (i + 1),
+                                       smoothSoa.getValue(i),
+                                       msg.c_str());
+    }
+  }
+}
+
+void test_state_lazy_recovery(void)
+{
+  const byte LAZY = 4;
+  const byte SAVED = 3;
+  byte state[512];
+  setup_range_difference(smoothFloat);
+  setup_range_difference(smoothSoa);
+  smoothFloat.setLazy(LAZY);
+  smoothSoa.setLazy(LAZY);
+  smoothFloat.setRecovery(RECOVERY);
+  smoothSoa.setRecovery(RECOVERY);
+  TEST_ASSERT_TRUE(smoothFloat.getStateSize() <= sizeof(state));
+  for (byte j = 0; j < SAVED; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      smoothFloat.setValue(STEP_LIST[j] * (i + 1), i);
+    }
+  }
+  // Queued input value and recovery streak superseded by restored state
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    smoothSoa.setValue(STEP_LIST[0] * (i + 1), i);
+    smoothSoa.setValue(STEP_LIST[SAVED] * (i + 1), i);
+    smoothSoa.setValue(STEP_LIST[SAVED + 1] * (i + 1), i);
+  }
+  size_t size = smoothFloat.saveState(state, sizeof(state));
+  // Recovery streaks of the origin start again as at restoring
+  smoothFloat.setRecovery(RECOVERY);
+  TEST_ASSERT_TRUE(smoothSoa.loadState(state, size));
+  for (byte j = SAVED; j < STEPS; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      // Testee
+      smoothFloat.setValue(STEP_LIST[j] * (i + 1), i);
+      smoothSoa.setValue(STEP_LIST[j] * (i + 1), i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_TRUE_MESSAGE(
+        STEP_VALID_LIST[j] == smoothSoa.isValid(i), msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothFloat.getValue(i) == smoothSoa.getValue(i), msg.c_str());
+    }
+  }
+}
+
+void test_float_timestamp(void)
+{
+  float valInput, valActual, valExpected, valPrevious;
+  unsigned long timePrevious;
+  setup_range_difference(smoothFloat);
+  smoothFloat.setInterval(INTERVAL);
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    for (byte j = 0; j < SAMPLES; j++)
+    {
+      valInput = SAMPLE_LIST[j] * (i + 1);
+      // Algorithm
+      float ratio =
+        j ? (float)(TIMESTAMP_LIST[j] - timePrevious) / INTERVAL : 1.0;
+      bool flValid = valInput >= MINIMUM * (i + 1) &&
+                     valInput <= MAXIMUM * (i + 1) &&
+                     (!j || fabs(valInput - valPrevious) <=
+                              DIFFERENCE * (i + 1) * ratio);
+      if (flValid)
+      {
+        float factor = 1.0 - pow(1.0 - EXPONENTIAL_FACTOR, ratio);
+        valExpected = j ? valExpected + factor * (valInput - valExpected)
+                        : valInput;
+        valPrevious = valInput;
+        timePrevious = TIMESTAMP_LIST[j];
+      }
+      // Testee
+      smoothFloat.setValue(valInput, TIMESTAMP_LIST[j], i);
+      valActual = smoothFloat.getValue(i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_TRUE_MESSAGE(flValid == smoothFloat.isValid(i), msg.c_str());
+      TEST_ASSERT_FLOAT_WITHIN_MESSAGE(
+        TOLERANCE * (i + 1), valExpected, valActual, msg.c_str());
+    }
+  }
+}
+
+template<class APP, typename DAT>
+void test_qformat(APP &smooth, float tolerance)
+{
+  DAT frame[MEASURES];
+  setup_range_difference(smoothGeneric);
+  setup_range_difference(smooth);
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      // Samples with exact fixed-point representation
+      float valInput = SAMPLE_LIST[(i + j) % SAMPLES] * (i + 1);
+      valInput = (float)(DAT)valInput;
+      frame[i] = valInput;
+      smoothGeneric.setValue(valInput, i);
+    }
+    // Testee
+    smooth.setValues(frame);
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_FLOAT_WITHIN_MESSAGE(tolerance * (i + 1),
+                                       smoothGeneric.getValue(i),
+                                       (float)smooth.getValue(i),
+                                       msg.c_str());
+      TEST_ASSERT_TRUE_MESSAGE(
+        smoothGeneric.isValid(i) == smooth.isValid(i), msg.c_str());
+    }
+  }
+}
+
+void test_q16_range_difference_values(void)
+{
+  test_qformat<decltype(smoothQ16), gbj_appsmooth_q16_16>(smoothQ16, 0.001);
+}
+
+void test_q16_timestamp(void)
+{
+  float valInput, valExpected, valPrevious;
+  unsigned long timePrevious;
+  setup_range_difference(smoothQ16);
+  smoothQ16.setInterval(INTERVAL);
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    for (byte j = 0; j < SAMPLES; j++)
+    {
+      valInput = SAMPLE_LIST[j] * (i + 1);
+      // Algorithm with the factor independent of timestamps
+      float ratio =
+        j ? (float)(TIMESTAMP_LIST[j] - timePrevious) / INTERVAL : 1.0;
+      bool flValid = valInput >= MINIMUM * (i + 1) &&
+                     valInput <= MAXIMUM * (i + 1) &&
+                     (!j || fabs(valInput - valPrevious) <=
+                              DIFFERENCE * (i + 1) * ratio);
+      if (flValid)
+      {
+        valExpected = j ? valExpected +
+                            EXPONENTIAL_FACTOR * (valInput - valExpected)
+                        : valInput;
+        valPrevious = valInput;
+        timePrevious = TIMESTAMP_LIST[j];
+      }
+      // Testee
+      smoothQ16.setValue(
+        gbj_appsmooth_q16_16(valInput), TIMESTAMP_LIST[j], i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_TRUE_MESSAGE(flValid == smoothQ16.isValid(i), msg.c_str());
+      TEST_ASSERT_FLOAT_WITHIN_MESSAGE(TOLERANCE * (i + 1),
+                                       valExpected,
+                                       (float)smoothQ16.getValue(i),
+                                       msg.c_str());
+    }
+  }
+}
+
+void test_q12_range_difference_values(void)
+{
+  test_qformat<decltype(smoothQ12), gbj_appsmooth_q12_4>(smoothQ12, 0.5);
+}
+
+void test_sweep(void)
+{
+  float errorSum[MEASURES] = {}, errorMax[MEASURES] = {};
+  unsigned long rejected[MEASURES] = {};
+  setup_range_difference(smoothGeneric);
+  sweep.begin(MEASURES);
+  for (byte k = 0; k < MEASURES; k++)
+  {
+    // Configurations of the first measure of the generic smoothing
+    float factor = EXPONENTIAL_FACTOR * (k % 4 + 1);
+    sweep.getMeasurePtr(k)->setFactor(factor);
+    smoothGeneric.getMeasurePtr(k)->setFactor(factor);
+    smoothGeneric.setMinimum(MINIMUM, k);
+    smoothGeneric.setMaximum(MAXIMUM, k);
+    smoothGeneric.setDifference(DIFFERENCE * (k / 4 + 1), k);
+    sweep.setMinimum(MINIMUM, k);
+    sweep.setMaximum(MAXIMUM, k);
+    sweep.setDifference(DIFFERENCE * (k / 4 + 1), k);
+  }
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    // Algorithm
+    for (byte k = 0; k < MEASURES; k++)
+    {
+      rejected[k] += !smoothGeneric.setValue(SAMPLE_LIST[j], k);
+      float error = fabs(smoothGeneric.getValue(k) - SAMPLE_LIST[j]);
+      errorSum[k] += error * error;
+      errorMax[k] = max(errorMax[k], error);
+    }
+    // Testee
+    sweep.setValue(SAMPLE_LIST[j]);
+  }
+  TEST_ASSERT_EQUAL_UINT(SAMPLES, sweep.getSamples());
+  for (byte k = 0; k < MEASURES; k++)
+  {
+    String msg = "k=" + String(k);
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(
+      rejected[k], sweep.getRejected(k), msg.c_str());
+    TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+      sqrt(errorSum[k] / SAMPLES), sweep.getError(k), msg.c_str());
+    TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+      errorMax[k], sweep.getErrorMax(k), msg.c_str());
+  }
+}
+
+void test_copy_move(void)
+{
+  typedef gbj_appsmooth<gbj_appsmooth_exponential, float, gbj_appsmooth_soa>
+    Smooth;
+  setup_range_difference(smoothSoa);
+  smoothSoa.setRecovery(RECOVERY);
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      smoothSoa.setValue(SAMPLE_LIST[(i + j) % SAMPLES] * (i + 1), i);
+    }
+  }
+  // Testee
+  Smooth smoothCopy = smoothSoa;
+  Smooth smoothMove = static_cast<Smooth &&>(smoothCopy);
+  TEST_ASSERT_EQUAL_UINT8(0, smoothCopy.getMeasures());
+  TEST_ASSERT_EQUAL_UINT8(MEASURES, smoothMove.getMeasures());
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    float valInput = STEP_LIST[i % STEPS] * (i + 1);
+    String msg = "i=" + String(i);
+    TEST_ASSERT_TRUE_MESSAGE(
+      smoothSoa.getValue(i) == smoothMove.getValue(i), msg.c_str());
+    TEST_ASSERT_TRUE_MESSAGE(
+      smoothSoa.setValue(valInput, i) == smoothMove.setValue(valInput, i),
+      msg.c_str());
+    TEST_ASSERT_TRUE_MESSAGE(
+      smoothSoa.getValue(i) == smoothMove.getValue(i), msg.c_str());
+  }
+}
+
+void test_uint_norange(void)
+{
+  setup_norange(smoothGenericUint);
+  setup_norange(smoothUint);
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    for (byte j = 0; j < SAMPLES; j++)
+    {
+      unsigned int valInput = SAMPLE_LIST[j] * (i + 1);
+      // Testee
+      smoothGenericUint.setValue(valInput, i);
+      smoothUint.setValue(valInput, i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_EQUAL_UINT_MESSAGE(
+        smoothGenericUint.getValue(i), smoothUint.getValue(i), msg.c_str());
+    }
+  }
+}
+
+//******************************************************************************
+// Run
+//******************************************************************************
+void setup()
+{
+  delay(2000);
+  UNITY_BEGIN();
+
+  RUN_TEST(test_factor_float);
+  RUN_TEST(test_float_range_difference);
+  RUN_TEST(test_soa_range_difference_values);
+  RUN_TEST(test_soa_shards);
+#if !defined(__AVR__)
+  RUN_TEST(test_soa_frame);
+#endif
+#if !defined(__AVR__)
+  RUN_TEST(test_wide_index);
+#endif
+  RUN_TEST(test_soa_lazy);
+#if !defined(__AVR__)
+  RUN_TEST(test_concurrent_range_difference);
+  RUN_TEST(test_concurrent_snapshot);
+#endif
+  RUN_TEST(test_float_timestamp);
+  RUN_TEST(test_queue_full_empty);
+  RUN_TEST(test_queue_wraparound);
+  RUN_TEST(test_queue_drain);
+  RUN_TEST(test_recovery);
+  RUN_TEST(test_state_lazy_recovery);
+  RUN_TEST(test_copy_move);
+  RUN_TEST(test_sweep);
+  //
+  RUN_TEST(test_q16_range_difference_values);
+  RUN_TEST(test_q16_timestamp);
+  RUN_TEST(test_q12_range_difference_values);
+  //
+  RUN_TEST(test_uint_norange);
+
+  UNITY_END();
+}
+
+void loop() {}
@@ -0,0 +1,426 @@
+/*
+  NAME:
+  Unit tests of application library "gbj_appsmoothing" for smoothing
+  with the built-in running statistics "gbj_appsmooth_running".
+
+  DESCRIPTION:
+  The test file provides test cases for smoothing measures of various data
+  types.
+  - The test runner is Unity Project - ThrowTheSwitch.org.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+*/
+#define SERIAL_NODEBUG
+#define GBJ_APPSMOOTH_STATS
+#include "gbj_appsmooth.h"
+#include "gbj_appsmooth_running.h"
+#include <Arduino.h>
+#include <unity.h>
+
+//******************************************************************************
+// Preparation
+//******************************************************************************
+const float MINIMUM = 300.0;
+const float MAXIMUM = 800.0;
+const float DIFFERENCE = 300.0;
+const byte SAMPLES_LIB = 5;
+const byte MEASURES = 2;
+const byte LAZY_DEPTH = 8;
+const byte LAZY_READ = 3;
+
+const float SAMPLE_LIST[] = { 423, 753, 217, 42, 898, 712, 728,
+                              510, 835, 77,  2,  956, 623, 319 };
+const byte SAMPLES = sizeof(SAMPLE_LIST) / sizeof(SAMPLE_LIST[0]);
+
+typedef gbj_appsmooth_running<SAMPLES_LIB> Running;
+typedef gbj_appsmooth_running<SAMPLES_LIB, int> RunningInt;
+
+gbj_appsmooth<Running, float> smoothFloat = gbj_appsmooth<Running, float>();
+gbj_appsmooth<Running, float> smoothLazy = gbj_appsmooth<Running, float>();
+gbj_appsmooth<RunningInt, int, gbj_appsmooth_soa> smoothInt =
+  gbj_appsmooth<RunningInt, int, gbj_appsmooth_soa>();
+
+#if !defined(__AVR__)
+// Window with indices beyond byte, which does not fit memory of AVR platforms
+const unsigned int WINDOW_LONG = 300;
+const unsigned int SAMPLES_LONG = 2 * WINDOW_LONG + 17;
+typedef gbj_appsmooth_running<WINDOW_LONG, int> RunningLong;
+gbj_appsmooth<RunningLong, int, gbj_appsmooth_soa> smoothLong =
+  gbj_appsmooth<RunningLong, int, gbj_appsmooth_soa>();
+int windowLong[WINDOW_LONG];
+#endif
+
+void setup_float_norange()
+{
+  smoothFloat.begin(MEASURES);
+}
+
+void setup_float_range()
+{
+  smoothFloat.begin(MEASURES);
+  for (byte i = 0; i < smoothFloat.getMeasures(); i++)
+  {
+    smoothFloat.setMinimum(MINIMUM * (i + 1), i);
+    smoothFloat.setMaximum(MAXIMUM * (i + 1), i);
+  }
+}
+
+void setup_float_median()
+{
+  smoothFloat.begin(MEASURES);
+  for (byte i = 0; i < smoothFloat.getMeasures(); i++)
+  {
+    smoothFloat.getMeasurePtr(i)->setMedian();
+  }
+}
+
+void setup_float_lazy()
+{
+  smoothFloat.begin(MEASURES);
+  smoothLazy.begin(MEASURES);
+  smoothLazy.setLazy(LAZY_DEPTH);
+  smoothFloat.getMeasurePtr(1)->setMedian();
+  smoothLazy.getMeasurePtr(1)->setMedian();
+}
+
+void setup_stats()
+{
+  smoothFloat.begin(MEASURES);
+  smoothInt.begin(MEASURES);
+  smoothFloat.setMinimum(MINIMUM, 0);
+  smoothFloat.setMaximum(MAXIMUM, 0);
+  smoothFloat.setDifference(DIFFERENCE, 1);
+  smoothInt.setMinimum(MINIMUM, 0);
+  smoothInt.setMaximum(MAXIMUM, 0);
+  smoothInt.setDifference(DIFFERENCE, 1);
+}
+
+void setup_int_extremes()
+{
+  smoothInt.begin(MEASURES);
+  smoothInt.getMeasurePtr(0)->setMinimum();
+  smoothInt.getMeasurePtr(1)->setMaximum();
+}
+
+#if !defined(__AVR__)
+// Sample of the rank in ascending order of a window counting from zero
+int select_rank(const int *window, unsigned int items, unsigned int rank)
+{
+  for (unsigned int k = 0; k < items; k++)
+  {
+    unsigned int less = 0, equal = 0;
+    for (unsigned int m = 0; m < items; m++)
+    {
+      less += window[m] < window[k];
+      equal += window[m] == window[k];
+    }
+    if (less <= rank && rank < less + equal)
+    {
+      return window[k];
+    }
+  }
+  return 0;
+}
+#endif
+
+//******************************************************************************
+// Tests
+//******************************************************************************
+void test_measures(void)
+{
+  byte valExpected, valActual;
+  valExpected = SAMPLES_LIB;
+  valActual = Running::SAMPLES;
+  TEST_ASSERT_EQUAL_UINT8(valExpected, valActual);
+}
+
+void test_float_norange(void)
+{
+  float valActual, valExpected;
+  setup_float_norange();
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    for (byte j = 0; j < SAMPLES; j++)
+    {
+      // Algorithm
+      int kStart = max(0, j + 1 - SAMPLES_LIB);
+      valExpected = 0;
+      for (byte k = kStart; k <= j; k++)
+      {
+        valExpected += SAMPLE_LIST[k] * (i + 1);
+      }
+      valExpected /= j + 1 - kStart;
+      // Testee
+      smoothFloat.setValue(SAMPLE_LIST[j] * (i + 1), i);
+      valActual = smoothFloat.getValue(i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(valExpected, valActual, msg.c_str());
+    }
+  }
+}
+
+void test_float_range(void)
+{
+  float valInput, valActual, valExpected;
+  byte items;
+  setup_float_range();
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    for (byte j = 0; j < SAMPLES; j++)
+    {
+      // Algorithm
+      int k = j;
+      items = 0;
+      valExpected = 0;
+      do
+      {
+        valInput = SAMPLE_LIST[k] * (i + 1);
+        if (valInput >= (MINIMUM * (i + 1)) && valInput <= (MAXIMUM * (i + 1)))
+        {
+          valExpected += valInput;
+          items++;
+        }
+      } while (items < SAMPLES_LIB && --k >= 0);
+      valExpected = items ? valExpected / items : 0;
+      // Testee
+      valInput = SAMPLE_LIST[j] * (i + 1);
+      smoothFloat.setValue(valInput, i);
+      valActual = smoothFloat.getValue(i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(valExpected, valActual, msg.c_str());
+    }
+  }
+}
+
+void test_float_median(void)
+{
+  float valActual, valExpected;
+  float window[SAMPLES_LIB];
+  setup_float_median();
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    for (byte j = 0; j < SAMPLES; j++)
+    {
+      // Algorithm by insertion sort of the window
+      int kStart = max(0, j + 1 - SAMPLES_LIB);
+      byte items = 0;
+      for (byte k = kStart; k <= j; k++, items++)
+      {
+        float valInput = SAMPLE_LIST[k] * (i + 1);
+        byte m = items;
+        for (; m > 0 && window[m - 1] > valInput; m--)
+        {
+          window[m] = window[m - 1];
+        }
+        window[m] = valInput;
+      }
+      valExpected = items % 2
+                      ? window[items / 2]
+                      : (window[items / 2 - 1] + window[items / 2]) / 2.0;
+      // Testee
+      smoothFloat.setValue(SAMPLE_LIST[j] * (i + 1), i);
+      valActual = smoothFloat.getValue(i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(valExpected, valActual, msg.c_str());
+    }
+  }
+}
+
+void test_float_lazy(void)
+{
+  float valActual, valExpected;
+  setup_float_lazy();
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    // Batches shorter and longer than the window and the depth
+    for (byte r = 0; r < 4; r++)
+    {
+      for (byte j = 0; j < SAMPLES; j++)
+      {
+        float valInput = SAMPLE_LIST[(j * (r + 1)) % SAMPLES] * (i + 1);
+        smoothFloat.setValue(valInput, i);
+        smoothLazy.setValue(valInput, i);
+        if ((j + r) % (LAZY_READ * (r + 1)) == 0)
+        {
+          // Testee
+          valExpected = smoothFloat.getValue(i);
+          valActual = smoothLazy.getValue(i);
+          String msg = "i=" + String(i) + ", r=" + String(r) +
+                       ", j=" + String(j);
+          TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+            valExpected, valActual, msg.c_str());
+        }
+      }
+    }
+  }
+}
+
+void test_stats(void)
+{
+  int frame[MEASURES];
+  setup_stats();
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      frame[i] = SAMPLE_LIST[j];
+      smoothFloat.setValue(SAMPLE_LIST[j], i);
+    }
+    smoothInt.setValues(frame);
+  }
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    // Algorithm
+    unsigned long valExpected[6] = {};
+    float valInput = SAMPLE_LIST[0];
+    for (byte j = 0; j < SAMPLES; j++)
+    {
+      float val = SAMPLE_LIST[j];
+      bool flMin = !i && val < MINIMUM;
+      bool flMax = !i && val > MAXIMUM;
+      bool flDif = i && fabs(val - valInput) > DIFFERENCE;
+      valExpected[1] += flMin;
+      valExpected[2] += !flMin && flMax;
+      valExpected[3] += !flMin && !flMax && flDif;
+      if (flMin || flMax || flDif)
+      {
+        valExpected[4]++;
+        valExpected[5] = max(valExpected[4], valExpected[5]);
+      }
+      else
+      {
+        valExpected[0]++;
+        valExpected[4] = 0;
+        valInput = val;
+      }
+    }
+    // Testee
+    const gbj_appsmooth<Running, float>::Stats &statsFloat =
+      smoothFloat.getStats(i);
+    const gbj_appsmooth<RunningInt, int, gbj_appsmooth_soa>::Stats
+      &statsInt = smoothInt.getStats()[i];
+    unsigned long valActual[2][6] = {
+      { statsFloat.accepted,
+        statsFloat.rejectedMin,
+        statsFloat.rejectedMax,
+        statsFloat.rejectedDif,
+        statsFloat.streak,
+        statsFloat.streakMax },
+      { statsInt.accepted,
+        statsInt.rejectedMin,
+        statsInt.rejectedMax,
+        statsInt.rejectedDif,
+        statsInt.streak,
+        statsInt.streakMax },
+    };
+    for (byte l = 0; l < 2; l++)
+    {
+      for (byte k = 0; k < 6; k++)
+      {
+        String msg = "i=" + String(i) + ", l=" + String(l) +
+                     ", k=" + String(k);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+          valExpected[k], valActual[l][k], msg.c_str());
+      }
+    }
+  }
+}
+
+void test_int_extremes(void)
+{
+  int valActual, valExpected;
+  int frame[MEASURES];
+  setup_int_extremes();
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    int kStart = max(0, j + 1 - SAMPLES_LIB);
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      frame[i] = SAMPLE_LIST[j];
+    }
+    // Testee
+    smoothInt.setValues(frame);
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      // Algorithm
+      valExpected = SAMPLE_LIST[kStart];
+      for (byte k = kStart; k <= j; k++)
+      {
+        valExpected = i ? max(valExpected, (int)SAMPLE_LIST[k])
+                        : min(valExpected, (int)SAMPLE_LIST[k]);
+      }
+      valActual = smoothInt.getValue(i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_EQUAL_INT_MESSAGE(valExpected, valActual, msg.c_str());
+    }
+  }
+}
+
+#if !defined(__AVR__)
+void test_long_window(void)
+{
+  smoothLong.begin(3);
+  smoothLong.getMeasurePtr(0)->setMedian();
+  smoothLong.getMeasurePtr(1)->setMinimum();
+  smoothLong.getMeasurePtr(2)->setMaximum();
+  unsigned long seed = 12345;
+  for (unsigned int j = 0; j < SAMPLES_LONG; j++)
+  {
+    // Pseudo-random samples with repeated values
+    seed = (seed * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+    int sample = (int)((seed >> 8) % 500);
+    windowLong[j % WINDOW_LONG] = sample;
+    unsigned int items = j < WINDOW_LONG ? j + 1 : WINDOW_LONG;
+    for (byte i = 0; i < 3; i++)
+    {
+      smoothLong.setValue(sample, i);
+    }
+    // Algorithm
+    float valMedian = items % 2
+                        ? select_rank(windowLong, items, items / 2)
+                        : (select_rank(windowLong, items, items / 2 - 1) +
+                           select_rank(windowLong, items, items / 2)) /
+                            2.0;
+    int valMinimum = select_rank(windowLong, items, 0);
+    int valMaximum = select_rank(windowLong, items, items - 1);
+    // Testee with the median of the smoother not truncated to data type
+    String msg = "j=" + String(j);
+    TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+      valMedian, smoothLong.getMeasurePtr(0)->getValue(), msg.c_str());
+    TEST_ASSERT_EQUAL_INT_MESSAGE(
+      valMinimum, smoothLong.getValue(1), msg.c_str());
+    TEST_ASSERT_EQUAL_INT_MESSAGE(
+      valMaximum, smoothLong.getValue(2), msg.c_str());
+  }
+}
+#endif
+
+//******************************************************************************
+// Run
+//******************************************************************************
+void setup()
+{
+  delay(2000);
+  UNITY_BEGIN();
+
+  RUN_TEST(test_measures);
+  RUN_TEST(test_float_norange);
+  RUN_TEST(test_float_range);
+  RUN_TEST(test_float_median);
+  RUN_TEST(test_float_lazy);
+  RUN_TEST(test_stats);
+  //
+  RUN_TEST(test_int_extremes);
+#if !defined(__AVR__)
+  RUN_TEST(test_long_window);
+#endif
+
+  UNITY_END();
+}
+
+void loop() {}
@@ -32,6 +32,11 @@ const byte MEASURES = 2;
 
 const float SAMPLE_LIST[] = { 42.3, 38.9, 45.0, 56.7, 61.7, 52.3, 41.1, 48.4 };
 const byte SAMPLES = sizeof(SAMPLE_LIST) / sizeof(SAMPLE_LIST[0]);
+const byte DECIMATION = 3;
+// Timestamps of input values with origin unrelated to millis()
+const unsigned long ORIGIN = 1000000000UL;
+const unsigned long INTERVAL = 10;
+const unsigned long PERIOD = 25;
 
 gbj_appsmooth<gbj_exponential, float> smoothFloat =
   gbj_appsmooth<gbj_exponential, float>();
@@ -39,6 +44,14 @@ gbj_appsmooth<gbj_exponential, float> smoothFloat =
 gbj_appsmooth<gbj_exponential, unsigned int> smoothUint =
   gbj_appsmooth<gbj_exponential, unsigned int>();
 
+gbj_appsmooth<gbj_exponential, float, gbj_appsmooth_soa> smoothSoa =
+  gbj_appsmooth<gbj_exponential, float, gbj_appsmooth_soa>();
+
+gbj_appsmooth<gbj_exponential, float>::Buffer<MEASURES> buffer;
+
+gbj_appsmooth_fixed<gbj_exponential, float, MEASURES> smoothFixed =
+  gbj_appsmooth_fixed<gbj_exponential, float, MEASURES>(MAXIMUM, MINIMUM);
+
 void setup_float_norange()
 {
   smoothFloat.begin(MEASURES);
@@ -48,6 +61,22 @@ void setup_float_norange()
   }
 }
 
+typedef gbj_appsmooth<gbj_exponential, float>::Output Output;
+Output published[SAMPLES];
+byte publishedCount;
+void publish(const Output &output)
+{
+  published[publishedCount++] = output;
+}
+
+void setup_float_decimation()
+{
+  setup_float_norange();
+  publishedCount = 0;
+  smoothFloat.setPublisher(publish);
+  smoothFloat.setDecimation(DECIMATION, 1);
+}
+
 void setup_float_norange_difference()
 {
   smoothFloat.begin(MEASURES);
@@ -81,6 +110,27 @@ void setup_float_range_difference()
   }
 }
 
+void setup_soa_range_difference()
+{
+  smoothSoa.begin(MEASURES);
+  for (byte i = 0; i < smoothSoa.getMeasures(); i++)
+  {
+    smoothSoa.getMeasurePtr(i)->setFactor(EXPONENTIAL_FACTOR);
+    smoothSoa.setMinimum(MINIMUM * (i + 1), i);
+    smoothSoa.setMaximum(MAXIMUM * (i + 1), i);
+    smoothSoa.setDifference(DIFFERENCE * (i + 1), i);
+  }
+}
+
+void setup_fixed_range()
+{
+  smoothFixed.begin();
+  for (byte i = 0; i < smoothFixed.getMeasures(); i++)
+  {
+    smoothFixed.getMeasurePtr(i)->setFactor(EXPONENTIAL_FACTOR);
+  }
+}
+
 void setup_uint_norange()
 {
   smoothUint.begin(MEASURES);
@@ -159,6 +209,68 @@ void test_float_norange(void)
   }
 }
 
+void test_float_decimation(void)
+{
+  float valExpected[SAMPLES];
+  byte countExpected = 0;
+  setup_float_decimation();
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      smoothFloat.setValue(SAMPLE_LIST[j] * (i + 1), i);
+    }
+    // Algorithm
+    if ((j + 1) % DECIMATION == 0)
+    {
+      valExpected[countExpected++] = smoothFloat.getValue(1);
+    }
+  }
+  // Testee
+  TEST_ASSERT_EQUAL_UINT8(countExpected, publishedCount);
+  for (byte k = 0; k < publishedCount; k++)
+  {
+    String msg = "k=" + String(k);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(1, published[k].idx, msg.c_str());
+    TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+      valExpected[k], published[k].value, msg.c_str());
+  }
+}
+
+void test_float_period(void)
+{
+  unsigned long timeExpected[SAMPLES], timePrevious = ORIGIN;
+  byte countExpected = 0;
+  setup_float_norange();
+  publishedCount = 0;
+  smoothFloat.setPublisher(publish);
+  smoothFloat.setInterval(INTERVAL);
+  smoothFloat.setPeriod(PERIOD, 1);
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    unsigned long timestamp = ORIGIN + j * INTERVAL;
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      smoothFloat.setValue(SAMPLE_LIST[j] * (i + 1), timestamp, i);
+    }
+    // Algorithm
+    if (timestamp - timePrevious >= PERIOD)
+    {
+      timeExpected[countExpected++] = timestamp;
+      timePrevious = timestamp;
+    }
+  }
+  // Testee
+  TEST_ASSERT_EQUAL_UINT8(countExpected, publishedCount);
+  for (byte k = 0; k < publishedCount; k++)
+  {
+    String msg = "k=" + String(k);
+    TEST_ASSERT_EQUAL_UINT8_MESSAGE(1, published[k].idx, msg.c_str());
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(
+      timeExpected[k], published[k].timestamp, msg.c_str());
+  }
+}
+
 void test_float_norange_difference(void)
 {
   float valInput, valInputOld, valActual, valExpected, valExpectedOld;
@@ -269,6 +381,249 @@ void test_float_range_difference(void)
   }
 }
 
+void test_float_range_difference_values(void)
+{
+  float frame[MEASURES];
+  byte valid[(MEASURES + 7) / 8];
+  gbj_appsmooth<gbj_exponential, float> smoothRef =
+    gbj_appsmooth<gbj_exponential, float>();
+  setup_float_range_difference();
+  smoothRef.begin(MEASURES);
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    smoothRef.getMeasurePtr(i)->setFactor(EXPONENTIAL_FACTOR);
+    smoothRef.setMinimum(MINIMUM * (i + 1), i);
+    smoothRef.setMaximum(MAXIMUM * (i + 1), i);
+    smoothRef.setDifference(DIFFERENCE * (i + 1), i);
+  }
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    byte accepted = 0;
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      frame[i] = SAMPLE_LIST[j] * (i + 1);
+      accepted += smoothRef.setValue(frame[i], i);
+    }
+    // Testee
+    String msg = "j=" + String(j);
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(
+      accepted, smoothFloat.setValues(frame, valid), msg.c_str());
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+        smoothRef.getValue(i), smoothFloat.getValue(i), msg.c_str());
+      TEST_ASSERT_EQUAL_UINT_MESSAGE(
+        smoothRef.isValid(i), (valid[i / 8] >> (i % 8)) & 1, msg.c_str());
+    }
+  }
+}
+
+void test_soa_range_difference(void)
+{
+  float frame[MEASURES];
+  byte valid[(MEASURES + 7) / 8];
+  setup_float_range_difference();
+  setup_soa_range_difference();
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      frame[i] = SAMPLE_LIST[j] * (i + 1);
+      smoothFloat.setValue(frame[i], i);
+    }
+    // Testee
+    if (j % 2)
+    {
+      smoothSoa.setValues(frame, valid);
+    }
+    else
+    {
+      for (byte i = 0; i < MEASURES; i++)
+      {
+        smoothSoa.setValue(frame[i], i);
+      }
+    }
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+        smoothFloat.getValue(i), smoothSoa.getValue(i), msg.c_str());
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+        smoothFloat.getInput(i), smoothSoa.getInput(i), msg.c_str());
+      TEST_ASSERT_EQUAL_UINT_MESSAGE(
+        smoothFloat.isValid(i), smoothSoa.isValid(i), msg.c_str());
+    }
+  }
+}
+
+void test_state_restore(void)
+{
+  byte state[256];
+  setup_float_range_difference();
+  for (byte j = 0; j < SAMPLES / 2; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      smoothFloat.setValue(SAMPLE_LIST[j] * (i + 1), i);
+    }
+  }
+  size_t size = smoothFloat.saveState(state, sizeof(state));
+  TEST_ASSERT_EQUAL_UINT(smoothFloat.getStateSize(), size);
+  // Restoring to other layout without configuration
+  smoothSoa.begin(MEASURES + 1);
+  TEST_ASSERT_FALSE(smoothSoa.loadState(state, size));
+  smoothSoa.begin(MEASURES);
+  TEST_ASSERT_FALSE(smoothSoa.loadState(state, size - 1));
+  TEST_ASSERT_TRUE(smoothSoa.loadState(state, size));
+  for (byte j = SAMPLES / 2; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      // Testee
+      smoothFloat.setValue(SAMPLE_LIST[j] * (i + 1), i);
+      smoothSoa.setValue(SAMPLE_LIST[j] * (i + 1), i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+        smoothFloat.getValue(i), smoothSoa.getValue(i), msg.c_str());
+      TEST_ASSERT_EQUAL_UINT_MESSAGE(
+        smoothFloat.isValid(i), smoothSoa.isValid(i), msg.c_str());
+    }
+  }
+}
+
+void test_state_mapped(void)
+{
+  alignas(64) static byte mapped[512];
+  memset(mapped, 0, sizeof(mapped));
+  setup_float_range_difference();
+  TEST_ASSERT_TRUE(smoothSoa.getMapSize(MEASURES) <= sizeof(mapped));
+  TEST_ASSERT_FALSE(smoothSoa.begin(mapped, sizeof(mapped), MEASURES));
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    smoothSoa.getMeasurePtr(i)->setFactor(EXPONENTIAL_FACTOR);
+    smoothSoa.setMinimum(MINIMUM * (i + 1), i);
+    smoothSoa.setMaximum(MAXIMUM * (i + 1), i);
+    smoothSoa.setDifference(DIFFERENCE * (i + 1), i);
+  }
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    if (j == SAMPLES / 2)
+    {
+      // Resuming from the same block without configuration
+      smoothSoa.begin(MEASURES);
+      TEST_ASSERT_TRUE(smoothSoa.begin(mapped, sizeof(mapped), MEASURES));
+    }
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      // Testee
+      smoothFloat.setValue(SAMPLE_LIST[j] * (i + 1), i);
+      smoothSoa.setValue(SAMPLE_LIST[j] * (i + 1), i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+        smoothFloat.getValue(i), smoothSoa.getValue(i), msg.c_str());
+      TEST_ASSERT_EQUAL_UINT_MESSAGE(
+        smoothFloat.isValid(i), smoothSoa.isValid(i), msg.c_str());
+    }
+  }
+  // Other number of measures is not resumed
+  TEST_ASSERT_FALSE(smoothSoa.begin(mapped, sizeof(mapped), MEASURES + 1));
+}
+
+void test_buffer_rebegin(void)
+{
+  float valInput, valActual, valExpected;
+  for (byte r = 0; r < 2; r++)
+  {
+    smoothFloat.begin(buffer);
+    TEST_ASSERT_EQUAL_UINT8(MEASURES, smoothFloat.getMeasures());
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      smoothFloat.getMeasurePtr(i)->setFactor(EXPONENTIAL_FACTOR);
+    }
+    for (byte j = 0; j < SAMPLES; j++)
+    {
+      for (byte i = 0; i < MEASURES; i++)
+      {
+        valInput = SAMPLE_LIST[(j + r) % SAMPLES] * (i + 1);
+        smoothFloat.setValue(valInput, i);
+        // Testee
+        if (j == 0)
+        {
+          // The first sample after begin passes through without history
+          valExpected = valInput;
+          valActual = smoothFloat.getValue(i);
+          String msg = "i=" + String(i) + ", r=" + String(r);
+          TEST_ASSERT_EQUAL_FLOAT_MESSAGE(
+            valExpected, valActual, msg.c_str());
+        }
+      }
+    }
+  }
+}
+
+void test_fixed_range(void)
+{
+  float valInput, valActual, valExpected, valExpectedOld;
+  setup_fixed_range();
+  TEST_ASSERT_EQUAL_UINT8(MEASURES, smoothFixed.getMeasures());
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    bool flInit = false;
+    valExpectedOld = 0;
+    for (byte j = 0; j < SAMPLES; j++)
+    {
+      valInput = SAMPLE_LIST[j];
+      // Algorithm
+      if (valInput < MINIMUM || valInput > MAXIMUM)
+      {
+        valExpected = valExpectedOld;
+      }
+      else if (flInit)
+      {
+        valExpectedOld += EXPONENTIAL_FACTOR * (valInput - valExpectedOld);
+        valExpected = valExpectedOld;
+      }
+      else
+      {
+        valExpected = valInput;
+        valExpectedOld = valExpected;
+        flInit = true;
+      }
+      // Testee
+      smoothFixed.setValue(valInput, i);
+      valActual = smoothFixed.getValue(i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(valExpected, valActual, msg.c_str());
+    }
+  }
+}
+
+void test_fixed_rebegin(void)
+{
+  float valInput, valActual, valExpected;
+  setup_fixed_range();
+  for (byte j = 0; j < SAMPLES; j++)
+  {
+    for (byte i = 0; i < MEASURES; i++)
+    {
+      smoothFixed.setValue(SAMPLE_LIST[j], i);
+    }
+  }
+  setup_fixed_range();
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    // The first sample after begin passes through without history
+    valInput = (MINIMUM + MAXIMUM) / 2 + i;
+    valExpected = valInput;
+    // Testee
+    smoothFixed.setValue(valInput, i);
+    valActual = smoothFixed.getValue(i);
+    String msg = "i=" + String(i);
+    TEST_ASSERT_EQUAL_FLOAT_MESSAGE(valExpected, valActual, msg.c_str());
+  }
+}
+
 void test_factor_uint(void)
 {
   float valActual, valExpected;
@@ -324,9 +679,18 @@ void setup()
   RUN_TEST(test_minimum_float);
   RUN_TEST(test_maximum_float);
   RUN_TEST(test_float_norange);
+  RUN_TEST(test_float_decimation);
+  RUN_TEST(test_float_period);
   RUN_TEST(test_float_norange_difference);
   RUN_TEST(test_float_range);
   RUN_TEST(test_float_range_difference);
+  RUN_TEST(test_float_range_difference_values);
+  RUN_TEST(test_soa_range_difference);
+  RUN_TEST(test_state_restore);
+  RUN_TEST(test_state_mapped);
+  RUN_TEST(test_buffer_rebegin);
+  RUN_TEST(test_fixed_range);
+  RUN_TEST(test_fixed_rebegin);
   //
   RUN_TEST(test_factor_uint);
   RUN_TEST(test_uint_norange);
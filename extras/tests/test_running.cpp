@@ -37,11 +37,21 @@ gbj_appsmooth<gbj_running, float> smoothFloat =
   gbj_appsmooth<gbj_running, float>();
 gbj_appsmooth<gbj_running, int> smoothUint = gbj_appsmooth<gbj_running, int>();
 
+gbj_appsmooth<gbj_running, float, gbj_appsmooth_soa> smoothSoa =
+  gbj_appsmooth<gbj_running, float, gbj_appsmooth_soa>();
+gbj_appsmooth<gbj_running, float, gbj_appsmooth_soa>::Buffer<MEASURES>
+  bufferSoa;
+
 void setup_float_norange()
 {
   smoothFloat.begin(MEASURES);
 }
 
+void setup_soa_norange()
+{
+  smoothSoa.begin(bufferSoa);
+}
+
 void setup_float_range()
 {
   smoothFloat.begin(MEASURES);
@@ -124,6 +134,32 @@ void test_float_norange(void)
   }
 }
 
+void test_soa_norange(void)
+{
+  float valActual, valExpected;
+  setup_soa_norange();
+  TEST_ASSERT_EQUAL_UINT8(MEASURES, smoothSoa.getMeasures());
+  for (byte i = 0; i < MEASURES; i++)
+  {
+    for (byte j = 0; j < SAMPLES; j++)
+    {
+      // Algorithm
+      int kStart = max(0, j + 1 - SAMPLES_LIB);
+      valExpected = 0;
+      for (byte k = kStart; k <= j; k++)
+      {
+        valExpected += SAMPLE_LIST[k] * (i + 1);
+      }
+      valExpected /= j + 1 - kStart;
+      // Testee
+      smoothSoa.setValue(SAMPLE_LIST[j] * (i + 1), i);
+      valActual = smoothSoa.getValue(i);
+      String msg = "i=" + String(i) + ", j=" + String(j);
+      TEST_ASSERT_EQUAL_FLOAT_MESSAGE(valExpected, valActual, msg.c_str());
+    }
+  }
+}
+
 void test_float_range(void)
 {
   float valInput, valActual, valExpected;
@@ -194,6 +230,7 @@ void setup()
   RUN_TEST(test_maximum_float);
   RUN_TEST(test_float_norange);
   RUN_TEST(test_float_range);
+  RUN_TEST(test_soa_norange);
   //
   RUN_TEST(test_uint_norange);
 
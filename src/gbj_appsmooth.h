@@ -21,142 +21,2287 @@
 #if defined(__AVR__)
   #include <Arduino.h>
   #include <inttypes.h>
+  #include <new.h>
 #elif defined(ESP8266) || defined(ESP32)
   #include <Arduino.h>
+  #include <new>
+#elif defined(ARDUINO)
+  // Other Arduino cores, e.g., SAMD, RP2040, STM32, Teensy
+  #include <Arduino.h>
+  #include <new>
+#else
+  // Host platform with the standard library instead of the Arduino SDK
+  #include <chrono>
+  #include <new>
+  #include <stdint.h>
+  #include <thread>
+typedef uint8_t byte;
+inline unsigned long millis()
+{
+  return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(
+           std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+}
+#endif
+#if !defined(__AVR__)
+  #include <atomic>
+#endif
+#include <string.h>
+#if defined(__AVX2__)
+  #include <immintrin.h>
+#elif defined(__SSE2__)
+  #include <emmintrin.h>
+#endif
+
+#undef SERIAL_PREFIX
+#define SERIAL_PREFIX "gbj_appsmooth"
+
+// Size of memory block, which is cached by a processor at once
+#ifndef GBJ_APPSMOOTH_CACHE_LINE
+  #define GBJ_APPSMOOTH_CACHE_LINE 64
+#endif
+
+/*
+  Counter of processor cycles for timing of processing of input values
+
+  DESCRIPTION:
+  The counter is used by statistics of measures, if the macro
+  GBJ_APPSMOOTH_STATS_TIMING is defined along with GBJ_APPSMOOTH_STATS.
+  - The x86 platforms read the time stamp counter and Espressif platforms the
+    cycle counter of the processor.
+  - The AVR platforms and other Arduino cores count microseconds and host
+    platforms count nanoseconds of the steady clock instead.
+*/
+#if defined(GBJ_APPSMOOTH_STATS_TIMING)
+  #if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+  #endif
+inline unsigned long gbj_appsmooth_cycles()
+{
+  #if defined(__x86_64__) || defined(__i386__)
+  return (unsigned long)__rdtsc();
+  #elif defined(ESP8266) || defined(ESP32)
+  return ESP.getCycleCount();
+  #elif defined(__AVR__) || defined(ARDUINO)
+  return micros();
+  #else
+  return (unsigned long)std::chrono::duration_cast<std::chrono::nanoseconds>(
+           std::chrono::steady_clock::now().time_since_epoch())
+    .count();
+  #endif
+}
 #endif
 
-#undef SERIAL_PREFIX
-#define SERIAL_PREFIX "gbj_appsmooth"
+// Greater of two values independent of the max() macro or function of
+// particular platforms
+template<typename T>
+inline T gbj_appsmooth_max(T a, T b)
+{
+  return a < b ? b : a;
+}
+
+/*
+  Checking an input value against valid range and valid change
+
+  DESCRIPTION:
+  The function is common for all storage layouts of measures' cache.
+  - It is written without short-circuit branches, so that it can be evaluated
+    for a block of measures by the compiler in a vectorized way.
+
+  RETURN:
+  Flag determining whether the input value is valid.
+*/
+template<typename DAT>
+inline bool gbj_appsmooth_check(DAT val,
+                                DAT input,
+                                DAT minimum,
+                                DAT maximum,
+                                DAT difference,
+                                bool flMin,
+                                bool flMax,
+                                bool flDif,
+                                bool flRun)
+{
+  DAT change = val - input;
+  change = change < 0 ? -1 * change : change;
+  return !(flMin & (val < minimum)) & !(flMax & (val > maximum)) &
+         !(flRun & flDif & (change > difference));
+}
+
+/*
+  Smoothing kernel
+
+  DESCRIPTION:
+  The template is the static interface of the application library to
+  a smoother, so that calls of the smoother are resolved at compile time and
+  can be inlined.
+  - The generic template calls the getters of a smoothing library, which are
+    available for all generic smoothing libraries.
+  - A specialization for a particular smoother type can replace those calls
+    with its own code operating directly on the smoother as on a compact state
+    of a measure, e.g., by a fused multiply-add for exponential filtering.
+  - The method for a block of measures is used by the structure of arrays
+    layout for smoothers placed in a contiguous array.
+  - The method for a batch of samples of a measure is used by the lazy
+    evaluation. A specialization can fold the batch in one pass.
+  - The method with the ratio of the elapsed time to the nominal sampling
+    interval is used for timestamped input values. The generic template
+    ignores it, while a specialization can adjust smoothing to it.
+*/
+template<class SMT, typename DAT>
+struct gbj_appsmooth_kernel
+{
+  // Initial smoothed value of a measure
+  static inline DAT getValue(SMT &smoother) { return (DAT)smoother.getValue(); }
+  // New smoothed value of a measure
+  static inline DAT getValue(SMT &smoother, DAT data)
+  {
+    return (DAT)smoother.getValue((DAT)data);
+  }
+  // New smoothed value of a measure after (ratio) nominal sampling intervals
+  static inline DAT getValue(SMT &smoother, DAT data, float)
+  {
+    return getValue(smoother, data);
+  }
+  // New smoothed values of a block of up to 8 measures flagged in the mask
+  static inline void getValues(SMT *smoother,
+                               const DAT *data,
+                               DAT *output,
+                               byte mask)
+  {
+    for (byte k = 0; mask; k++, mask >>= 1)
+    {
+      if (mask & 1)
+      {
+        output[k] = getValue(smoother[k], data[k]);
+      }
+    }
+  }
+  // Smoothed value after a batch of at least one sample of a measure
+  static inline DAT getBatch(SMT &smoother, const DAT *data, byte count)
+  {
+    DAT value = getValue(smoother, data[0]);
+    for (byte k = 1; k < count; k++)
+    {
+      value = getValue(smoother, data[k]);
+    }
+    return value;
+  }
+};
+
+/*
+  Scaling of the valid difference by elapsed time
+
+  DESCRIPTION:
+  The template scales the valid difference of a measure for a timestamped
+  input value by the time elapsed since the recent accepted input value in
+  proportion to the nominal sampling interval.
+  - The generic template multiplies the difference by the ratio of them in
+    floating point arithmetic.
+  - A specialization for a data type can scale it in its own arithmetic,
+    e.g., fixed-point types in integer arithmetic.
+
+  PARAMETERS:
+  difference - Valid difference for the nominal sampling interval.
+    - Data type: templated
+  ratio - Ratio of the elapsed time to the nominal sampling interval.
+    - Data type: float
+  elapsed, interval - Elapsed time and nominal sampling interval.
+    - Data type: non-negative integer
+
+  RETURN:
+  Valid difference for the elapsed time.
+*/
+template<typename DAT>
+struct gbj_appsmooth_elapse
+{
+  static inline DAT getDifference(DAT difference,
+                                  float ratio,
+                                  unsigned long,
+                                  unsigned long)
+  {
+    return (DAT)(difference * ratio);
+  }
+};
+
+/*
+  Checking a block of 8 input values against valid range and valid change
+
+  DESCRIPTION:
+  The template is used by the structure of arrays layout for checking full
+  blocks of measures, which flags are stored in one byte of flag bitsets.
+  - The generic template checks values one by one.
+  - Specializations for float, int, and unsigned int data types on x86
+    platforms check the block at once with SSE2 or AVX2 instructions without
+    branches. They return the same results as the scalar check. Other data
+    types with the same representation, e.g., 32-bit fixed-point types, can
+    reuse them.
+
+  PARAMETERS:
+  val, input, minimum, maximum, difference - Pointers to arrays of 8 input
+  values, recent valid input values, and limits.
+    - Data type: pointer to templated
+  flMin, flMax, flDif, flRun - Bytes of flag bitsets for the block.
+    - Data type: non-negative integer
+
+  RETURN:
+  Byte of bitset of flags determining whether input values are valid.
+*/
+template<typename DAT>
+struct gbj_appsmooth_gate
+{
+  static inline byte check(const DAT *val,
+                           const DAT *input,
+                           const DAT *minimum,
+                           const DAT *maximum,
+                           const DAT *difference,
+                           byte flMin,
+                           byte flMax,
+                           byte flDif,
+                           byte flRun)
+  {
+    byte mask = 0;
+    for (byte k = 0; k < 8; k++)
+    {
+      mask |= gbj_appsmooth_check(val[k],
+                                  input[k],
+                                  minimum[k],
+                                  maximum[k],
+                                  difference[k],
+                                  (flMin >> k) & 1,
+                                  (flMax >> k) & 1,
+                                  (flDif >> k) & 1,
+                                  (flRun >> k) & 1)
+              << k;
+    }
+    return mask;
+  }
+};
+
+#if defined(__AVX2__)
+// Lanes with all bits set for flags set in the byte
+inline __m256i gbj_appsmooth_lanes(byte flags)
+{
+  const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(flags), bits),
+                            bits);
+}
+
+template<>
+struct gbj_appsmooth_gate<float>
+{
+  static inline byte check(const float *val,
+                           const float *input,
+                           const float *minimum,
+                           const float *maximum,
+                           const float *difference,
+                           byte flMin,
+                           byte flMax,
+                           byte flDif,
+                           byte flRun)
+  {
+    __m256 v = _mm256_loadu_ps(val);
+    __m256 chg = _mm256_andnot_ps(_mm256_set1_ps(-0.0f),
+                                  _mm256_sub_ps(v, _mm256_loadu_ps(input)));
+    __m256 fail = _mm256_or_ps(
+      _mm256_or_ps(
+        _mm256_and_ps(
+          _mm256_castsi256_ps(gbj_appsmooth_lanes(flMin)),
+          _mm256_cmp_ps(v, _mm256_loadu_ps(minimum), _CMP_LT_OQ)),
+        _mm256_and_ps(
+          _mm256_castsi256_ps(gbj_appsmooth_lanes(flMax)),
+          _mm256_cmp_ps(v, _mm256_loadu_ps(maximum), _CMP_GT_OQ))),
+      _mm256_and_ps(
+        _mm256_castsi256_ps(gbj_appsmooth_lanes(flDif & flRun)),
+        _mm256_cmp_ps(chg, _mm256_loadu_ps(difference), _CMP_GT_OQ)));
+    return ~_mm256_movemask_ps(fail);
+  }
+};
+
+template<bool SIGNED>
+struct gbj_appsmooth_gate_epi32
+{
+  // Signed comparison of unsigned values is done with flipped sign bits
+  static inline __m256i load(const void *data)
+  {
+    __m256i v = _mm256_loadu_si256(static_cast<const __m256i *>(data));
+    return SIGNED ? v : _mm256_xor_si256(v, _mm256_set1_epi32(0x80000000));
+  }
+  static inline byte check(const void *val,
+                           const void *input,
+                           const void *minimum,
+                           const void *maximum,
+                           const void *difference,
+                           byte flMin,
+                           byte flMax,
+                           byte flDif,
+                           byte flRun)
+  {
+    __m256i v = _mm256_loadu_si256(static_cast<const __m256i *>(val));
+    __m256i chg = _mm256_sub_epi32(
+      v, _mm256_loadu_si256(static_cast<const __m256i *>(input)));
+    if (SIGNED)
+    {
+      chg = _mm256_abs_epi32(chg);
+    }
+    else
+    {
+      chg = _mm256_xor_si256(chg, _mm256_set1_epi32(0x80000000));
+      v = _mm256_xor_si256(v, _mm256_set1_epi32(0x80000000));
+    }
+    __m256i fail = _mm256_or_si256(
+      _mm256_or_si256(
+        _mm256_and_si256(gbj_appsmooth_lanes(flMin),
+                         _mm256_cmpgt_epi32(load(minimum), v)),
+        _mm256_and_si256(gbj_appsmooth_lanes(flMax),
+                         _mm256_cmpgt_epi32(v, load(maximum)))),
+      _mm256_and_si256(gbj_appsmooth_lanes(flDif & flRun),
+                       _mm256_cmpgt_epi32(chg, load(difference))));
+    return ~_mm256_movemask_ps(_mm256_castsi256_ps(fail));
+  }
+};
+
+#elif defined(__SSE2__)
+// Lanes with all bits set for flags set in the lower nibble of the byte
+inline __m128i gbj_appsmooth_lanes(byte flags)
+{
+  const __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+  return _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(flags), bits), bits);
+}
+
+template<>
+struct gbj_appsmooth_gate<float>
+{
+  static inline byte check4(const float *val,
+                            const float *input,
+                            const float *minimum,
+                            const float *maximum,
+                            const float *difference,
+                            byte flMin,
+                            byte flMax,
+                            byte flChg)
+  {
+    __m128 v = _mm_loadu_ps(val);
+    __m128 chg =
+      _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(v, _mm_loadu_ps(input)));
+    __m128 fail = _mm_or_ps(
+      _mm_or_ps(_mm_and_ps(_mm_castsi128_ps(gbj_appsmooth_lanes(flMin)),
+                           _mm_cmplt_ps(v, _mm_loadu_ps(minimum))),
+                _mm_and_ps(_mm_castsi128_ps(gbj_appsmooth_lanes(flMax)),
+                           _mm_cmpgt_ps(v, _mm_loadu_ps(maximum)))),
+      _mm_and_ps(_mm_castsi128_ps(gbj_appsmooth_lanes(flChg)),
+                 _mm_cmpgt_ps(chg, _mm_loadu_ps(difference))));
+    return ~_mm_movemask_ps(fail) & 0x0F;
+  }
+  static inline byte check(const float *val,
+                           const float *input,
+                           const float *minimum,
+                           const float *maximum,
+                           const float *difference,
+                           byte flMin,
+                           byte flMax,
+                           byte flDif,
+                           byte flRun)
+  {
+    byte flChg = flDif & flRun;
+    return check4(
+             val, input, minimum, maximum, difference, flMin, flMax, flChg) |
+           check4(val + 4,
+                  input + 4,
+                  minimum + 4,
+                  maximum + 4,
+                  difference + 4,
+                  flMin >> 4,
+                  flMax >> 4,
+                  flChg >> 4)
+             << 4;
+  }
+};
+
+template<bool SIGNED>
+struct gbj_appsmooth_gate_epi32
+{
+  // Signed comparison of unsigned values is done with flipped sign bits
+  static inline __m128i load(const void *data)
+  {
+    __m128i v = _mm_loadu_si128(static_cast<const __m128i *>(data));
+    return SIGNED ? v : _mm_xor_si128(v, _mm_set1_epi32(0x80000000));
+  }
+  static inline byte check4(const int *val,
+                            const int *input,
+                            const int *minimum,
+                            const int *maximum,
+                            const int *difference,
+                            byte flMin,
+                            byte flMax,
+                            byte flChg)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(val));
+    __m128i chg = _mm_sub_epi32(
+      v, _mm_loadu_si128(reinterpret_cast<const __m128i *>(input)));
+    if (SIGNED)
+    {
+      __m128i sign = _mm_srai_epi32(chg, 31);
+      chg = _mm_sub_epi32(_mm_xor_si128(chg, sign), sign);
+    }
+    else
+    {
+      chg = _mm_xor_si128(chg, _mm_set1_epi32(0x80000000));
+      v = _mm_xor_si128(v, _mm_set1_epi32(0x80000000));
+    }
+    __m128i fail = _mm_or_si128(
+      _mm_or_si128(_mm_and_si128(gbj_appsmooth_lanes(flMin),
+                                 _mm_cmplt_epi32(v, load(minimum))),
+                   _mm_and_si128(gbj_appsmooth_lanes(flMax),
+                                 _mm_cmpgt_epi32(v, load(maximum)))),
+      _mm_and_si128(gbj_appsmooth_lanes(flChg),
+                    _mm_cmpgt_epi32(chg, load(difference))));
+    return ~_mm_movemask_ps(_mm_castsi128_ps(fail)) & 0x0F;
+  }
+  static inline byte check(const void *val,
+                           const void *input,
+                           const void *minimum,
+                           const void *maximum,
+                           const void *difference,
+                           byte flMin,
+                           byte flMax,
+                           byte flDif,
+                           byte flRun)
+  {
+    const int *v = static_cast<const int *>(val);
+    const int *i = static_cast<const int *>(input);
+    const int *n = static_cast<const int *>(minimum);
+    const int *x = static_cast<const int *>(maximum);
+    const int *d = static_cast<const int *>(difference);
+    byte flChg = flDif & flRun;
+    return check4(v, i, n, x, d, flMin, flMax, flChg) |
+           check4(v + 4, i + 4, n + 4, x + 4, d + 4, flMin >> 4, flMax >> 4,
+                  flChg >> 4)
+             << 4;
+  }
+};
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+template<>
+struct gbj_appsmooth_gate<int> : gbj_appsmooth_gate_epi32<true>
+{};
+template<>
+struct gbj_appsmooth_gate<unsigned int> : gbj_appsmooth_gate_epi32<false>
+{};
+#endif
+
+/*
+  Storage layouts of measures' cache
+
+  DESCRIPTION:
+  The layout is provided to the application library as a template parameter
+  and determines, how the cached values and flags of all measures are placed
+  in memory. All layouts provide the same interface of the nested template
+  Cache, so that the application library has the same interface for them.
+  - Measures are indexed by the templated index type, so that the number of
+    measures is limited just by that type and available memory.
+  - Instance objects of smoothers are stored by value in the cache, so that
+    the entire cache occupies just one block of memory, either allocated at
+    once or provided statically by a sketch in form of the nested template
+    Storage.
+  - gbj_appsmooth_aos: Array of structures with one record per measure.
+    Suitable for lower number of measures processed individually.
+  - gbj_appsmooth_soa: Structure of arrays with separate array for each cached
+    value and packed bitsets for flags. Suitable for higher number of measures
+    processed by the method setValues(), which checks the whole frame by
+    sweeping only the arrays it needs.
+  - gbj_appsmooth_concurrent: Array of structures with records aligned to
+    cache lines and guarded by sequence counters. Suitable for measures
+    updated by different threads without locks, while readers get consistent
+    snapshots of smoothed values and validity. Just those are published to
+    other threads atomically, while other getters and setters of a measure
+    belong to the thread updating it. It is not available on AVR platforms.
+  - Each layout has the identifier for persistent states and can be mapped
+    to a memory block provided by a sketch with the alignment of the layout,
+    which contains no pointers, so that it can be resumed from a memory
+    mapped file.
+*/
+// Bits of flags of a measure in its persistent state
+enum gbj_appsmooth_flags
+{
+  GBJ_APPSMOOTH_FLAG_MIN = 1,
+  GBJ_APPSMOOTH_FLAG_MAX = 2,
+  GBJ_APPSMOOTH_FLAG_DIF = 4,
+  GBJ_APPSMOOTH_FLAG_RUN = 8,
+  GBJ_APPSMOOTH_FLAG_VALID = 16,
+};
+
+// Memory block allocated by a cache of measures and reused by its next begin
+struct gbj_appsmooth_memory
+{
+  byte *memory = NULL;
+  size_t capacity = 0;
+
+  inline byte *reserve(size_t size)
+  {
+    if (size > capacity)
+    {
+      release();
+      memory = new byte[size];
+      capacity = size;
+    }
+    return memory;
+  }
+  inline void release()
+  {
+    delete[] memory;
+    memory = NULL;
+    capacity = 0;
+  }
+};
+
+/*
+  Number of measures in a shard of an array
+
+  DESCRIPTION:
+  The shard is the least number of measures in whole bytes of flags, which
+  items of the size fill whole cache lines, so that shards of an array aligned
+  to the cache line do not share any line. The size of the cache line should
+  be a power of 2.
+
+  PARAMETERS:
+  size - Size of an item of the array in bytes.
+    - Data type: non-negative integer
+
+  RETURN: Number of measures in a shard
+*/
+inline size_t gbj_appsmooth_shard(size_t size)
+{
+  // The greatest power of 2 dividing the size up to the cache line
+  size_t part = size & (~size + 1);
+  part = part && part < GBJ_APPSMOOTH_CACHE_LINE ? part
+                                                 : GBJ_APPSMOOTH_CACHE_LINE;
+  size_t shard = GBJ_APPSMOOTH_CACHE_LINE / part;
+  return shard < 8 ? 8 : shard;
+}
+
+#if !defined(__AVR__)
+// Waiting of a thread for other threads in a spin loop
+inline void gbj_appsmooth_pause()
+{
+  #if defined(ESP8266) || defined(ESP32) || defined(ARDUINO)
+  yield();
+  #else
+  std::this_thread::yield();
+  #endif
+}
+#endif
+
+struct gbj_appsmooth_aos
+{
+  static const byte ID = 1;
+  template<class SMT, typename DAT, typename IDX>
+  struct Cache
+  {
+    struct Smoother
+    {
+      DAT valueInput;
+      DAT valueOutput;
+      DAT minimum;
+      DAT maximum;
+      DAT difference;
+      // Should be after DAT members
+      SMT smoother;
+      // Test for minimum if true
+      bool flMin;
+      // Test for maximum if true
+      bool flMax;
+      // Test for difference if true
+      bool flDif;
+      // Running after initialization
+      bool flRun;
+      // Input accepted
+      bool flValid;
+      bool setInput(DAT val) { return setInput(val, difference); }
+      bool setInput(DAT val, DAT dif)
+      {
+        // Test
+        flValid = gbj_appsmooth_check(val,
+                                      valueInput,
+                                      minimum,
+                                      maximum,
+                                      dif,
+                                      flMin,
+                                      flMax,
+                                      flDif,
+                                      flRun);
+        if (flValid)
+        {
+          flRun = true;
+          valueInput = val;
+        }
+        return flValid;
+      }
+      bool setValue(DAT val)
+      {
+        // Evaluation
+        if (setInput(val))
+        {
+          valueOutput = gbj_appsmooth_kernel<SMT, DAT>::getValue(smoother, val);
+        }
+        return flValid;
+      }
+      bool setValue(DAT val, DAT dif, float ratio)
+      {
+        if (setInput(val, dif))
+        {
+          valueOutput =
+            gbj_appsmooth_kernel<SMT, DAT>::getValue(smoother, val, ratio);
+        }
+        return flValid;
+      }
+      byte getFlags()
+      {
+        return flMin * GBJ_APPSMOOTH_FLAG_MIN | flMax * GBJ_APPSMOOTH_FLAG_MAX |
+               flDif * GBJ_APPSMOOTH_FLAG_DIF | flRun * GBJ_APPSMOOTH_FLAG_RUN |
+               flValid * GBJ_APPSMOOTH_FLAG_VALID;
+      }
+      void setRecord(const DAT *values, byte flags)
+      {
+        valueInput = values[0];
+        valueOutput = values[1];
+        minimum = values[2];
+        maximum = values[3];
+        difference = values[4];
+        flMin = flags & GBJ_APPSMOOTH_FLAG_MIN;
+        flMax = flags & GBJ_APPSMOOTH_FLAG_MAX;
+        flDif = flags & GBJ_APPSMOOTH_FLAG_DIF;
+        flRun = flags & GBJ_APPSMOOTH_FLAG_RUN;
+        flValid = flags & GBJ_APPSMOOTH_FLAG_VALID;
+      }
+    };
+    template<IDX N>
+    struct Storage
+    {
+      Smoother smoothers[N];
+    };
+    Smoother *smoothers = NULL;
+    // Allocated block and number of smoothers constructed in it
+    gbj_appsmooth_memory heap;
+    IDX items = 0;
+
+    void begin(IDX measures)
+    {
+      destroy();
+      map(heap.reserve(getSize(measures)), measures, false);
+      items = measures;
+    }
+    void end()
+    {
+      destroy();
+      heap.release();
+      smoothers = NULL;
+    }
+    void destroy()
+    {
+      for (IDX i = 0; i < items; i++)
+      {
+        smoothers[i].~Smoother();
+      }
+      items = 0;
+    }
+    template<IDX N>
+    void begin(Storage<N> &storage)
+    {
+      // Smoothers start again without history of previous begin
+      for (IDX i = 0; i < N; i++)
+      {
+        storage.smoothers[i].~Smoother();
+        new (&storage.smoothers[i]) Smoother();
+      }
+      bind(storage);
+      init(N);
+    }
+    template<IDX N>
+    void bind(Storage<N> &storage)
+    {
+      smoothers = storage.smoothers;
+    }
+    static const size_t ALIGN = alignof(Smoother);
+    static inline size_t getSize(IDX measures)
+    {
+      return measures * sizeof(Smoother);
+    }
+    static inline size_t getShard()
+    {
+      return gbj_appsmooth_shard(sizeof(Smoother));
+    }
+    void map(byte *block, IDX measures, bool flResume)
+    {
+      smoothers = reinterpret_cast<Smoother *>(block);
+      if (!flResume)
+      {
+        for (IDX i = 0; i < measures; i++)
+        {
+          new (&smoothers[i]) Smoother();
+        }
+        init(measures);
+      }
+    }
+    void init(IDX measures)
+    {
+      for (IDX i = 0; i < measures; i++)
+      {
+        smoothers[i].valueOutput =
+          gbj_appsmooth_kernel<SMT, DAT>::getValue(smoothers[i].smoother);
+        smoothers[i].valueInput = smoothers[i].valueOutput;
+        smoothers[i].flRun = false;
+        smoothers[i].flValid = true;
+      }
+    }
+    inline bool setValue(DAT data, IDX idx)
+    {
+      return smoothers[idx].setValue(data);
+    }
+    inline bool setInput(DAT data, IDX idx)
+    {
+      return smoothers[idx].setInput(data);
+    }
+    inline bool setValue(DAT data, IDX idx, DAT dif, float ratio)
+    {
+      return smoothers[idx].setValue(data, dif, ratio);
+    }
+    inline bool setInput(DAT data, IDX idx, DAT dif)
+    {
+      return smoothers[idx].setInput(data, dif);
+    }
+    inline void setBatch(const DAT *data, byte count, IDX idx)
+    {
+      smoothers[idx].valueOutput = gbj_appsmooth_kernel<SMT, DAT>::getBatch(
+        smoothers[idx].smoother, data, count);
+    }
+    IDX setValues(const DAT *data, byte *valid, IDX first, IDX last)
+    {
+      IDX accepted = 0;
+      byte mask = 0, range = 0;
+      for (IDX i = first; i < last; i++)
+      {
+        range |= 1 << (i & 7);
+        if (smoothers[i].setValue(data[i]))
+        {
+          mask |= 1 << (i & 7);
+          accepted++;
+        }
+        if ((i & 7) == 7 || i == last - 1)
+        {
+          // Flags of measures out of range are kept intact
+          if (valid)
+          {
+            valid[i >> 3] = (valid[i >> 3] & ~range) | mask;
+          }
+          mask = range = 0;
+        }
+      }
+      return accepted;
+    }
+    inline void setMinimum(DAT data, IDX idx)
+    {
+      smoothers[idx].minimum = data;
+      smoothers[idx].flMin = true;
+    }
+    inline void setMaximum(DAT data, IDX idx)
+    {
+      smoothers[idx].maximum = data;
+      smoothers[idx].flMax = true;
+    }
+    inline void setDifference(DAT data, IDX idx)
+    {
+      smoothers[idx].difference = data;
+      smoothers[idx].flDif = true;
+    }
+    inline void resetMinimum(IDX idx) { smoothers[idx].flMin = false; }
+    inline void resetMaximum(IDX idx) { smoothers[idx].flMax = false; }
+    inline void resetDifference(IDX idx) { smoothers[idx].flDif = false; }
+    inline SMT *getSmoother(IDX idx) { return &smoothers[idx].smoother; }
+    inline DAT getValue(IDX idx) { return smoothers[idx].valueOutput; }
+    inline DAT getInput(IDX idx) { return smoothers[idx].valueInput; }
+    inline DAT getMinimum(IDX idx) { return smoothers[idx].minimum; }
+    inline DAT getMaximum(IDX idx) { return smoothers[idx].maximum; }
+    inline DAT getDifference(IDX idx) { return smoothers[idx].difference; }
+    inline bool isValid(IDX idx) { return smoothers[idx].flValid; }
+    inline byte getFlags(IDX idx) { return smoothers[idx].getFlags(); }
+    inline void setRecord(const DAT *values, byte flags, IDX idx)
+    {
+      smoothers[idx].setRecord(values, flags);
+    }
+  };
+};
+
+struct gbj_appsmooth_soa
+{
+  static const byte ID = 2;
+  template<class SMT, typename DAT, typename IDX>
+  struct Cache
+  {
+    DAT *valueInput;
+    DAT *valueOutput;
+    DAT *minimum;
+    DAT *maximum;
+    DAT *difference;
+    SMT *smoother = NULL;
+    // Packed bitsets of flags with bit (idx % 8) in byte (idx / 8)
+    byte *flMin;
+    byte *flMax;
+    byte *flDif;
+    byte *flRun;
+    byte *flValid;
+
+    static inline bool getFlag(const byte *flags, IDX idx)
+    {
+      return (flags[idx >> 3] >> (idx & 7)) & 1;
+    }
+    static inline void setFlag(byte *flags, IDX idx)
+    {
+      flags[idx >> 3] |= 1 << (idx & 7);
+    }
+    static inline void resetFlag(byte *flags, IDX idx)
+    {
+      flags[idx >> 3] &= ~(1 << (idx & 7));
+    }
+
+    // Arrays start at cache lines, so that shards of a frame processed by
+    // different threads do not share them. AVR platforms have no cache.
+#if defined(__AVR__)
+    static const size_t ALIGN =
+      alignof(SMT) > alignof(DAT) ? alignof(SMT) : alignof(DAT);
+#else
+    static const size_t ALIGN = GBJ_APPSMOOTH_CACHE_LINE;
+#endif
+    template<IDX N>
+    struct Storage
+    {
+      alignas(ALIGN) SMT smoother[N];
+      alignas(ALIGN) DAT valueInput[N];
+      alignas(ALIGN) DAT valueOutput[N];
+      alignas(ALIGN) DAT minimum[N];
+      alignas(ALIGN) DAT maximum[N];
+      alignas(ALIGN) DAT difference[N];
+      byte flags[5][(N + 7) >> 3];
+    };
+
+    // Arrays are placed in one block each starting at the alignment
+    static inline size_t align(size_t offset)
+    {
+      return (offset + ALIGN - 1) / ALIGN * ALIGN;
+    }
+    static inline size_t getOffsetDat(IDX measures)
+    {
+      return align(measures * sizeof(SMT));
+    }
+    static inline size_t getStrideDat(IDX measures)
+    {
+      return align(measures * sizeof(DAT));
+    }
+    static inline size_t getOffsetFlags(IDX measures)
+    {
+      return getOffsetDat(measures) + 5 * getStrideDat(measures);
+    }
+    static inline size_t getSize(IDX measures)
+    {
+      return getOffsetFlags(measures) + 5 * (size_t)((measures + 7) >> 3);
+    }
+    // Shards end at cache lines in arrays of smoothers and values as well
+    static inline size_t getShard()
+    {
+      size_t shard = gbj_appsmooth_shard(sizeof(SMT));
+      size_t shardDat = gbj_appsmooth_shard(sizeof(DAT));
+      return shard > shardDat ? shard : shardDat;
+    }
+    // Allocated block and number of smoothers constructed in it
+    gbj_appsmooth_memory heap;
+    IDX items = 0;
+
+    void begin(IDX measures)
+    {
+      destroy();
+      // Block aligned explicitly for arrays starting at cache lines
+      byte *memory = heap.reserve(getSize(measures) + ALIGN - 1);
+      size_t offset = reinterpret_cast<size_t>(memory) % ALIGN;
+      map(memory + (offset ? ALIGN - offset : 0), measures, false);
+      items = measures;
+    }
+    void end()
+    {
+      destroy();
+      heap.release();
+      smoother = NULL;
+    }
+    void destroy()
+    {
+      for (IDX i = 0; i < items; i++)
+      {
+        smoother[i].~SMT();
+      }
+      items = 0;
+    }
+    void map(byte *block, IDX measures, bool flResume)
+    {
+      IDX bytes = (measures + 7) >> 3;
+      byte *flags = block + getOffsetFlags(measures);
+      size_t offset = getOffsetDat(measures);
+      size_t stride = getStrideDat(measures);
+      smoother = reinterpret_cast<SMT *>(block);
+      valueInput = reinterpret_cast<DAT *>(block + offset);
+      valueOutput = reinterpret_cast<DAT *>(block + offset + stride);
+      minimum = reinterpret_cast<DAT *>(block + offset + 2 * stride);
+      maximum = reinterpret_cast<DAT *>(block + offset + 3 * stride);
+      difference = reinterpret_cast<DAT *>(block + offset + 4 * stride);
+      flMin = flags;
+      flMax = flags + bytes;
+      flDif = flags + 2 * bytes;
+      flRun = flags + 3 * bytes;
+      flValid = flags + 4 * bytes;
+      if (!flResume)
+      {
+        for (IDX i = 0; i < measures; i++)
+        {
+          new (&smoother[i]) SMT();
+        }
+        init(measures);
+      }
+    }
+    template<IDX N>
+    void begin(Storage<N> &storage)
+    {
+      // Smoothers start again without history of previous begin
+      for (IDX i = 0; i < N; i++)
+      {
+        storage.smoother[i].~SMT();
+        new (&storage.smoother[i]) SMT();
+      }
+      bind(storage);
+      init(N);
+    }
+    template<IDX N>
+    void bind(Storage<N> &storage)
+    {
+      smoother = storage.smoother;
+      valueInput = storage.valueInput;
+      valueOutput = storage.valueOutput;
+      minimum = storage.minimum;
+      maximum = storage.maximum;
+      difference = storage.difference;
+      flMin = storage.flags[0];
+      flMax = storage.flags[1];
+      flDif = storage.flags[2];
+      flRun = storage.flags[3];
+      flValid = storage.flags[4];
+    }
+    void init(IDX measures)
+    {
+      IDX bytes = (measures + 7) >> 3;
+      for (IDX i = 0; i < bytes; i++)
+      {
+        flMin[i] = flMax[i] = flDif[i] = flRun[i] = 0x00;
+        flValid[i] = 0xFF;
+      }
+      for (IDX i = 0; i < measures; i++)
+      {
+        valueOutput[i] = gbj_appsmooth_kernel<SMT, DAT>::getValue(smoother[i]);
+        valueInput[i] = valueOutput[i];
+      }
+    }
+    inline bool setInput(DAT data, IDX idx)
+    {
+      return setInput(data, idx, difference[idx]);
+    }
+    inline bool setInput(DAT data, IDX idx, DAT dif)
+    {
+      bool valid = gbj_appsmooth_check(data,
+                                       valueInput[idx],
+                                       minimum[idx],
+                                       maximum[idx],
+                                       dif,
+                                       getFlag(flMin, idx),
+                                       getFlag(flMax, idx),
+                                       getFlag(flDif, idx),
+                                       getFlag(flRun, idx));
+      if (valid)
+      {
+        setFlag(flValid, idx);
+        setFlag(flRun, idx);
+        valueInput[idx] = data;
+      }
+      else
+      {
+        resetFlag(flValid, idx);
+      }
+      return valid;
+    }
+    inline bool setValue(DAT data, IDX idx)
+    {
+      bool valid = setInput(data, idx);
+      if (valid)
+      {
+        valueOutput[idx] =
+          gbj_appsmooth_kernel<SMT, DAT>::getValue(smoother[idx], data);
+      }
+      return valid;
+    }
+    inline bool setValue(DAT data, IDX idx, DAT dif, float ratio)
+    {
+      bool valid = setInput(data, idx, dif);
+      if (valid)
+      {
+        valueOutput[idx] = gbj_appsmooth_kernel<SMT, DAT>::getValue(
+          smoother[idx], data, ratio);
+      }
+      return valid;
+    }
+    inline void setBatch(const DAT *data, byte count, IDX idx)
+    {
+      valueOutput[idx] =
+        gbj_appsmooth_kernel<SMT, DAT>::getBatch(smoother[idx], data, count);
+    }
+    IDX setValues(const DAT *data, byte *valid, IDX first, IDX last)
+    {
+      IDX accepted = 0;
+      // Validation sweep over value arrays by blocks of flag bytes
+      for (IDX j = first >> 3; j <= (last - 1) >> 3; j++)
+      {
+        byte mask = 0;
+        IDX base = j << 3;
+        byte lead = first > base ? first - base : 0;
+        byte count = last - base < 8 ? last - base : 8;
+        byte range = (byte)(0xFF << lead) & (byte)(0xFF >> (8 - count));
+        if (range == 0xFF)
+        {
+          mask = gbj_appsmooth_gate<DAT>::check(data + base,
+                                                valueInput + base,
+                                                minimum + base,
+                                                maximum + base,
+                                                difference + base,
+                                                flMin[j],
+                                                flMax[j],
+                                                flDif[j],
+                                                flRun[j]);
+        }
+        else
+        {
+          for (byte k = lead; k < count; k++)
+          {
+            IDX i = base + k;
+            mask |= gbj_appsmooth_check(data[i],
+                                        valueInput[i],
+                                        minimum[i],
+                                        maximum[i],
+                                        difference[i],
+                                        (flMin[j] >> k) & 1,
+                                        (flMax[j] >> k) & 1,
+                                        (flDif[j] >> k) & 1,
+                                        (flRun[j] >> k) & 1)
+                    << k;
+          }
+        }
+        // Flags of measures out of range are kept intact
+        flValid[j] = (flValid[j] & ~range) | mask;
+        flRun[j] |= mask;
+        if (valid)
+        {
+          valid[j] = (valid[j] & ~range) | mask;
+        }
+        // Evaluation of accepted values only
+        gbj_appsmooth_kernel<SMT, DAT>::getValues(
+          smoother + base, data + base, valueOutput + base, mask);
+        for (byte k = 0; mask; k++, mask >>= 1)
+        {
+          if (mask & 1)
+          {
+            valueInput[base + k] = data[base + k];
+            accepted++;
+          }
+        }
+      }
+      return accepted;
+    }
+    inline void setMinimum(DAT data, IDX idx)
+    {
+      minimum[idx] = data;
+      setFlag(flMin, idx);
+    }
+    inline void setMaximum(DAT data, IDX idx)
+    {
+      maximum[idx] = data;
+      setFlag(flMax, idx);
+    }
+    inline void setDifference(DAT data, IDX idx)
+    {
+      difference[idx] = data;
+      setFlag(flDif, idx);
+    }
+    inline void resetMinimum(IDX idx) { resetFlag(flMin, idx); }
+    inline void resetMaximum(IDX idx) { resetFlag(flMax, idx); }
+    inline void resetDifference(IDX idx) { resetFlag(flDif, idx); }
+    inline SMT *getSmoother(IDX idx) { return &smoother[idx]; }
+    inline DAT getValue(IDX idx) { return valueOutput[idx]; }
+    inline DAT getInput(IDX idx) { return valueInput[idx]; }
+    inline DAT getMinimum(IDX idx) { return minimum[idx]; }
+    inline DAT getMaximum(IDX idx) { return maximum[idx]; }
+    inline DAT getDifference(IDX idx) { return difference[idx]; }
+    inline bool isValid(IDX idx) { return getFlag(flValid, idx); }
+    inline byte getFlags(IDX idx)
+    {
+      return getFlag(flMin, idx) * GBJ_APPSMOOTH_FLAG_MIN |
+             getFlag(flMax, idx) * GBJ_APPSMOOTH_FLAG_MAX |
+             getFlag(flDif, idx) * GBJ_APPSMOOTH_FLAG_DIF |
+             getFlag(flRun, idx) * GBJ_APPSMOOTH_FLAG_RUN |
+             getFlag(flValid, idx) * GBJ_APPSMOOTH_FLAG_VALID;
+    }
+    inline void setRecord(const DAT *values, byte flags, IDX idx)
+    {
+      valueInput[idx] = values[0];
+      valueOutput[idx] = values[1];
+      minimum[idx] = values[2];
+      maximum[idx] = values[3];
+      difference[idx] = values[4];
+      byte *bitsets[] = { flMin, flMax, flDif, flRun, flValid };
+      for (byte k = 0; k < 5; k++)
+      {
+        if ((flags >> k) & 1)
+        {
+          setFlag(bitsets[k], idx);
+        }
+        else
+        {
+          resetFlag(bitsets[k], idx);
+        }
+      }
+    }
+  };
+};
+
+#if !defined(__AVR__)
+struct gbj_appsmooth_concurrent
+{
+  static const byte ID = 3;
+  template<class SMT, typename DAT, typename IDX>
+  struct Cache
+  {
+    typedef typename gbj_appsmooth_aos::template Cache<SMT, DAT, IDX>::Smoother
+      Record;
+    // Record in its own cache line with odd sequence during its update.
+    // The record is accessed just by the thread updating the measure, while
+    // other threads read the smoothed value and validity published from it.
+    struct alignas(GBJ_APPSMOOTH_CACHE_LINE) Smoother
+    {
+      std::atomic<unsigned int> sequence;
+      std::atomic<DAT> valueOutput;
+      std::atomic<bool> flValid;
+      Record record;
+    };
+    template<IDX N>
+    struct Storage
+    {
+      Smoother smoothers[N];
+    };
+    Smoother *smoothers = NULL;
+    // Allocated block and number of smoothers constructed in it
+    gbj_appsmooth_memory heap;
+    IDX items = 0;
+
+    static const size_t ALIGN = GBJ_APPSMOOTH_CACHE_LINE;
+    static inline size_t getSize(IDX measures)
+    {
+      return measures * sizeof(Smoother);
+    }
+    static inline size_t getShard()
+    {
+      return gbj_appsmooth_shard(sizeof(Smoother));
+    }
+    void begin(IDX measures)
+    {
+      destroy();
+      // Over-aligned records are placed in a block aligned explicitly
+      byte *memory =
+        heap.reserve(getSize(measures) + GBJ_APPSMOOTH_CACHE_LINE - 1);
+      size_t offset = reinterpret_cast<size_t>(memory) %
+                      GBJ_APPSMOOTH_CACHE_LINE;
+      map(memory + (offset ? GBJ_APPSMOOTH_CACHE_LINE - offset : 0),
+          measures,
+          false);
+      items = measures;
+    }
+    void end()
+    {
+      destroy();
+      heap.release();
+      smoothers = NULL;
+    }
+    void destroy()
+    {
+      for (IDX i = 0; i < items; i++)
+      {
+        smoothers[i].~Smoother();
+      }
+      items = 0;
+    }
+    void map(byte *block, IDX measures, bool flResume)
+    {
+      smoothers = reinterpret_cast<Smoother *>(block);
+      if (!flResume)
+      {
+        for (IDX i = 0; i < measures; i++)
+        {
+          new (&smoothers[i]) Smoother();
+        }
+        init(measures);
+        return;
+      }
+      // Records interrupted during update are released
+      for (IDX i = 0; i < measures; i++)
+      {
+        std::atomic<unsigned int> &sequence = smoothers[i].sequence;
+        sequence.store(sequence.load(std::memory_order_relaxed) & ~1U,
+                       std::memory_order_relaxed);
+      }
+    }
+    template<IDX N>
+    void begin(Storage<N> &storage)
+    {
+      // Smoothers start again without history of previous begin
+      for (IDX i = 0; i < N; i++)
+      {
+        storage.smoothers[i].~Smoother();
+        new (&storage.smoothers[i]) Smoother();
+      }
+      bind(storage);
+      init(N);
+    }
+    template<IDX N>
+    void bind(Storage<N> &storage)
+    {
+      smoothers = storage.smoothers;
+    }
+    void init(IDX measures)
+    {
+      for (IDX i = 0; i < measures; i++)
+      {
+        Record &record = smoothers[i].record;
+        smoothers[i].sequence.store(0, std::memory_order_relaxed);
+        record.valueOutput =
+          gbj_appsmooth_kernel<SMT, DAT>::getValue(record.smoother);
+        record.valueInput = record.valueOutput;
+        record.flRun = false;
+        record.flValid = true;
+        publish(i);
+      }
+    }
+    // Sequence of a record is odd during its update
+    inline unsigned int lock(IDX idx)
+    {
+      std::atomic<unsigned int> &sequence = smoothers[idx].sequence;
+      unsigned int seq = sequence.load(std::memory_order_relaxed);
+      sequence.store(seq + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      return seq;
+    }
+    inline void unlock(IDX idx, unsigned int seq)
+    {
+      publish(idx);
+      smoothers[idx].sequence.store(seq + 2, std::memory_order_release);
+    }
+    inline void publish(IDX idx)
+    {
+      Smoother &smoother = smoothers[idx];
+      smoother.valueOutput.store(smoother.record.valueOutput,
+                                 std::memory_order_relaxed);
+      smoother.flValid.store(smoother.record.flValid,
+                             std::memory_order_relaxed);
+    }
+    inline bool setValue(DAT data, IDX idx)
+    {
+      unsigned int seq = lock(idx);
+      bool valid = smoothers[idx].record.setValue(data);
+      unlock(idx, seq);
+      return valid;
+    }
+    inline bool setInput(DAT data, IDX idx)
+    {
+      unsigned int seq = lock(idx);
+      bool valid = smoothers[idx].record.setInput(data);
+      unlock(idx, seq);
+      return valid;
+    }
+    inline bool setValue(DAT data, IDX idx, DAT dif, float ratio)
+    {
+      unsigned int seq = lock(idx);
+      bool valid = smoothers[idx].record.setValue(data, dif, ratio);
+      unlock(idx, seq);
+      return valid;
+    }
+    inline bool setInput(DAT data, IDX idx, DAT dif)
+    {
+      unsigned int seq = lock(idx);
+      bool valid = smoothers[idx].record.setInput(data, dif);
+      unlock(idx, seq);
+      return valid;
+    }
+    inline void setBatch(const DAT *data, byte count, IDX idx)
+    {
+      unsigned int seq = lock(idx);
+      Record &record = smoothers[idx].record;
+      record.valueOutput =
+        gbj_appsmooth_kernel<SMT, DAT>::getBatch(record.smoother, data, count);
+      unlock(idx, seq);
+    }
+    IDX setValues(const DAT *data, byte *valid, IDX first, IDX last)
+    {
+      IDX accepted = 0;
+      byte mask = 0, range = 0;
+      for (IDX i = first; i < last; i++)
+      {
+        range |= 1 << (i & 7);
+        if (setValue(data[i], i))
+        {
+          mask |= 1 << (i & 7);
+          accepted++;
+        }
+        if ((i & 7) == 7 || i == last - 1)
+        {
+          // Flags of measures out of range are kept intact
+          if (valid)
+          {
+            valid[i >> 3] = (valid[i >> 3] & ~range) | mask;
+          }
+          mask = range = 0;
+        }
+      }
+      return accepted;
+    }
+    bool getSnapshot(DAT &value, IDX idx)
+    {
+      std::atomic<unsigned int> &sequence = smoothers[idx].sequence;
+      unsigned int seqBegin, seqEnd;
+      bool valid;
+      do
+      {
+        seqBegin = sequence.load(std::memory_order_acquire);
+        value = smoothers[idx].valueOutput.load(std::memory_order_relaxed);
+        valid = smoothers[idx].flValid.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        seqEnd = sequence.load(std::memory_order_relaxed);
+      } while ((seqBegin & 1) || seqBegin != seqEnd);
+      return valid;
+    }
+    inline void setMinimum(DAT data, IDX idx)
+    {
+      smoothers[idx].record.minimum = data;
+      smoothers[idx].record.flMin = true;
+    }
+    inline void setMaximum(DAT data, IDX idx)
+    {
+      smoothers[idx].record.maximum = data;
+      smoothers[idx].record.flMax = true;
+    }
+    inline void setDifference(DAT data, IDX idx)
+    {
+      smoothers[idx].record.difference = data;
+      smoothers[idx].record.flDif = true;
+    }
+    inline void resetMinimum(IDX idx) { smoothers[idx].record.flMin = false; }
+    inline void resetMaximum(IDX idx) { smoothers[idx].record.flMax = false; }
+    inline void resetDifference(IDX idx)
+    {
+      smoothers[idx].record.flDif = false;
+    }
+    inline SMT *getSmoother(IDX idx) { return &smoothers[idx].record.smoother; }
+    inline DAT getValue(IDX idx)
+    {
+      DAT value;
+      getSnapshot(value, idx);
+      return value;
+    }
+    inline DAT getInput(IDX idx) { return smoothers[idx].record.valueInput; }
+    inline DAT getMinimum(IDX idx) { return smoothers[idx].record.minimum; }
+    inline DAT getMaximum(IDX idx) { return smoothers[idx].record.maximum; }
+    inline DAT getDifference(IDX idx)
+    {
+      return smoothers[idx].record.difference;
+    }
+    inline bool isValid(IDX idx)
+    {
+      DAT value;
+      return getSnapshot(value, idx);
+    }
+    inline byte getFlags(IDX idx) { return smoothers[idx].record.getFlags(); }
+    inline void setRecord(const DAT *values, byte flags, IDX idx)
+    {
+      unsigned int seq = lock(idx);
+      smoothers[idx].record.setRecord(values, flags);
+      unlock(idx, seq);
+    }
+  };
+};
+#endif
+
+template<class SMT,
+         typename DAT = float,
+         class LAY = gbj_appsmooth_aos,
+         typename IDX = byte,
+         IDX CNT = 0>
+class gbj_appsmooth
+{
+  typedef typename LAY::template Cache<SMT, DAT, IDX> Cache;
+
+public:
+  /*
+    Constructor
+
+    DESCRIPTION:
+    Overloaded constructor creates the class instance object and sets general
+    limit(s) for valid range of all measures.
+    - Just one constructor's argument is considered as maximum of the range.
+
+    PARAMETERS:
+    valMax - Maximum of a valid range of a data item.
+      - Data type: templated
+    valMin - Minimum of a valid range of a data item.
+      - Data type: templated
+    valMin - Maximal absolute valid change between subsequent data items.
+      - Data type: templated
+
+    RETURN: object
+  */
+  inline gbj_appsmooth() {}
+  inline gbj_appsmooth(DAT valMax)
+  {
+    valMax_ = valMax;
+    flGenMax_ = true;
+  }
+  inline gbj_appsmooth(DAT valMax, DAT valMin)
+  {
+    if (valMin > valMax)
+    {
+      valMin_ = valMax;
+      valMax_ = valMin;
+    }
+    else
+    {
+      valMin_ = valMin;
+      valMax_ = valMax;
+    }
+    flGenMin_ = flGenMax_ = true;
+  }
+  inline gbj_appsmooth(DAT valMax, DAT valMin, DAT valDif)
+  {
+    if (valMin > valMax)
+    {
+      valMin_ = valMax;
+      valMax_ = valMin;
+    }
+    else
+    {
+      valMin_ = valMin;
+      valMax_ = valMax;
+    }
+    valDif_ = (valDif < 0 ? -1 * valDif : valDif);
+    flGenMin_ = flGenMax_ = flGenDif_ = true;
+  }
+  /*
+    Lifetime of an instance object
+
+    DESCRIPTION:
+    The instance object owns all memory allocated by it, which is released
+    by the destructor.
+    - A copy contains all measures with their settings in its own memory, so
+      that it is independent of the original one.
+    - A move transfers all memory and measures to the target without any
+      allocation and copying of measures, while the source is left without
+      measures and should be initiated by the method begin() for further use.
+  */
+  inline ~gbj_appsmooth() { release(); }
+  inline gbj_appsmooth(const gbj_appsmooth &other) { assign(other); }
+  inline gbj_appsmooth &operator=(const gbj_appsmooth &other)
+  {
+    if (this != &other)
+    {
+      assign(other);
+    }
+    return *this;
+  }
+  inline gbj_appsmooth(gbj_appsmooth &&other) { take(other); }
+  inline gbj_appsmooth &operator=(gbj_appsmooth &&other)
+  {
+    if (this != &other)
+    {
+      release();
+      take(other);
+    }
+    return *this;
+  }
+
+  /*
+    Initialization.
+
+    DESCRIPTION:
+    The method initiates exponential filtering for statistical smoothing.
+    - It creates individual filter object for each data item provided.
+    - The cache with all filter objects is allocated as one block of memory.
+    - It should be called in the SETUP section of a sketch.
+
+    PARAMETERS:
+    measures - Number of measures to be filtered, which means number of used
+    smoothers. It initiates (defines) valid measures range.
+    - Data type: positive integer of templated index type
+    - Default value: 1
+    - Limited range: 1 ~ maximum of index type
+
+    RETURN: none
+  */
+  inline void begin(IDX measures = 1)
+  {
+    setLazy(0);
+    freeDecimation();
+    setInterval(0);
+    setRecovery(0);
+    measures_ = gbj_appsmooth_max((IDX)1, measures);
+    cache_.begin(measures_);
+    init();
+    beginStats();
+  }
+
+  /*
+    Initialization with static storage.
+
+    DESCRIPTION:
+    The method initiates statistical smoothing in the same way as the method
+    begin() with number of measures, but the cache with smoothers is placed
+    in the storage provided by a sketch instead of dynamic memory.
+    - The storage is usually a global variable, so that no memory is allocated
+      at runtime at all.
+    - The number of measures is determined by the template parameter of the
+      storage.
+
+    PARAMETERS:
+    buffer - Storage for the cache of measures.
+      - Data type: Buffer<N> of the same class template instance
+      - Limited range: N = 1 ~ maximum of index type
+
+    RETURN: none
+  */
+  template<IDX N>
+  struct Buffer
+  {
+    typename Cache::template Storage<N> storage;
+  };
+  template<IDX N>
+  inline void begin(Buffer<N> &buffer)
+  {
+    setLazy(0);
+    freeDecimation();
+    setInterval(0);
+    setRecovery(0);
+    measures_ = N;
+    cache_.end();
+    cache_.begin(buffer.storage);
+    init();
+    beginStats();
+  }
 
-template<class SMT, typename DAT = float>
-class gbj_appsmooth
-{
-public:
   /*
-    Constructor
+    Initialization with persistent storage.
 
     DESCRIPTION:
-    Overloaded constructor creates the class instance object and sets general
-    limit(s) for valid range of all measures.
-    - Just one constructor's argument is considered as maximum of the range.
+    The method places the cache of measures directly in a memory block
+    provided by a sketch, usually a memory mapped file, and resumes smoothing
+    with the state stored in it, if there is any.
+    - The block starts with the header of 16 bytes with the signature "GM",
+      format version, byte order flag, size of the data type, layout
+      identifier, size of the smoother, and number of measures, all in
+      little-endian order, followed by the size of the cache in bytes.
+    - The cache follows at the offset rounded up to the alignment of the
+      layout and it is the same as the dynamically allocated one. It contains
+      no pointers, so that it is valid in any address of the block.
+    - If the header matches the instance object, the cache is used without
+      any initialization, copying, or parsing, including limits of measures.
+      Otherwise the cache is initiated and the header is written at last, so
+      that an interrupted initialization is repeated.
+    - The block should be aligned to the alignment of the layout, e.g., to
+      the cache line, which is true for memory mapped files. If it is too
+      small, the cache is allocated dynamically.
+    - The method getMapSize() returns the size of the block.
 
     PARAMETERS:
-    valMax - Maximum of a valid range of a data item.
-      - Data type: templated
-    valMin - Minimum of a valid range of a data item.
-      - Data type: templated
-    valMin - Maximal absolute valid change between subsequent data items.
-      - Data type: templated
+    buffer - Pointer to the memory block.
+      - Data type: pointer to non-negative integer
+    size - Size of the memory block in bytes.
+      - Data type: non-negative integer
+      - Limited range: getMapSize(measures) ~ maximal size_t
+    measures - Number of measures.
+      - Data type: positive integer of templated index type
+      - Limited range: 1 ~ maximum of index type
 
-    RETURN: object
+    RETURN:
+    Flag determining whether the state of measures has been resumed.
   */
-  inline gbj_appsmooth() {}
-  inline gbj_appsmooth(DAT valMax)
+  inline bool begin(byte *buffer, size_t size, IDX measures)
   {
-    valMax_ = valMax;
-    flGenMax_ = true;
+    if (size < getMapSize(measures))
+    {
+      begin(measures);
+      return false;
+    }
+    setLazy(0);
+    freeDecimation();
+    setInterval(0);
+    setRecovery(0);
+    measures_ = gbj_appsmooth_max((IDX)1, measures);
+    byte header[MAP_HEADER];
+    setHeader(header, 'M', LAY::ID);
+    size_t block = Cache::getSize(measures_);
+    for (byte k = 0; k < 4; k++)
+    {
+      header[STATE_HEADER + k] = (block >> (8 * k)) & 0xFF;
+    }
+    bool flResume = !memcmp(buffer, header, MAP_HEADER);
+    cache_.end();
+    cache_.map(buffer + getMapOffset(), measures_, flResume);
+    if (!flResume)
+    {
+      init();
+      memcpy(buffer, header, MAP_HEADER);
+    }
+    beginStats();
+    return flResume;
   }
-  inline gbj_appsmooth(DAT valMax, DAT valMin)
+  static inline size_t getMapSize(IDX measures)
   {
-    if (valMin > valMax)
+    return getMapOffset() +
+           Cache::getSize(gbj_appsmooth_max((IDX)1, measures));
+  }
+
+  /*
+    Calculate new smoothed value from provided input value and cache them both
+
+    DESCRIPTION:
+    The method calculates a new filtered value from the input value for
+    a particular data smoother determined by the index.
+    - Input value as well as filtered value is cached in the smoother and can
+      be returned by corresponding getter.
+
+    PARAMETERS:
+    data - Input value to be smoothed.
+      - Data type: templated
+    idx - Index or sequence order of a measure which value should be smoothed
+      counting from zero.
+      - Data type: non-negative integer
+      - Default value: 0
+      - Limited range: 0 ~ (measures - 1)
+
+    RETURN:
+    Flag determining whether input value has been accepted.
+  */
+  inline bool setValue(DAT data, IDX idx = 0)
+  {
+    unsigned long start = getCycles();
+    if (!lazy_)
     {
-      valMin_ = valMax;
-      valMax_ = valMin;
+      if (!cache_.setValue(data, idx) &&
+          !(recoveries_ && recover(data, idx, cache_.getDifference(idx), 1.0)))
+      {
+        return reject(data, idx, getCycles() - start);
+      }
     }
     else
     {
-      valMin_ = valMin;
-      valMax_ = valMax;
+      if (!cache_.setInput(data, idx) &&
+          !(recoveries_ && recover(data, idx, cache_.getDifference(idx), 1.0)))
+      {
+        return reject(data, idx, getCycles() - start);
+      }
+      enqueue(data, idx);
     }
-    flGenMin_ = flGenMax_ = true;
+    if (recoveries_)
+    {
+      recoveries_[idx].count = 0;
+    }
+    if (decimators_)
+    {
+      decimate(idx, millis());
+    }
+    return accept(idx, getCycles() - start);
   }
-  inline gbj_appsmooth(DAT valMax, DAT valMin, DAT valDif)
+
+  /*
+    Calculate new smoothed value from timestamped input value
+
+    DESCRIPTION:
+    The method smooths the input value in the same way as the method
+    setValue() without timestamp, but it takes into account the time elapsed
+    since the recent accepted input value of the measure, if the nominal
+    sampling interval is set by the method setInterval().
+    - The valid change of a measure defined for the nominal sampling interval
+      is scaled in proportion to the elapsed time, so that a valid jump after
+      a gap in sampling is not rejected.
+    - The ratio of the elapsed time to the nominal sampling interval is passed
+      to the smoothing kernel, so that a smoother can adjust its smoothing,
+      e.g., the built-in exponential filtering adjusts its factor.
+    - The first input value of a measure after setting the nominal interval
+      is considered as sampled in the nominal interval.
+    - The nominal sampling interval is reset by the method begin(), so that
+      the method setInterval() should be called after it.
+
+    PARAMETERS:
+    data - Input value to be smoothed.
+      - Data type: templated
+    timestamp - Time of sampling of the input value, usually in milliseconds.
+      - Data type: non-negative integer
+    idx - Index or sequence order of a measure which value should be smoothed
+      counting from zero.
+      - Data type: non-negative integer
+      - Limited range: 0 ~ (measures - 1)
+    interval - Nominal sampling interval, in which limits and smoothing factors
+    are defined, in the same units as timestamps.
+      - Data type: non-negative integer
+      - Limited range: 0 ~ 2^32 - 1 (0 for ignoring timestamps)
+
+    RETURN:
+    Flag determining whether input value has been accepted.
+  */
+  inline bool setValue(DAT data, unsigned long timestamp, IDX idx)
   {
-    if (valMin > valMax)
+    if (!stamps_)
     {
-      valMin_ = valMax;
-      valMax_ = valMin;
+      return setValue(data, idx);
+    }
+    unsigned long start = getCycles();
+    Stamp &stamp = stamps_[idx];
+    unsigned long elapsed =
+      stamp.flRun ? timestamp - stamp.timestamp : interval_;
+    float ratio = (float)elapsed / interval_;
+    DAT dif = gbj_appsmooth_elapse<DAT>::getDifference(
+      cache_.getDifference(idx), ratio, elapsed, interval_);
+    if (!lazy_)
+    {
+      if (!cache_.setValue(data, idx, dif, ratio) &&
+          !(recoveries_ && recover(data, idx, dif, ratio)))
+      {
+        return reject(data, idx, getCycles() - start);
+      }
     }
     else
     {
-      valMin_ = valMin;
-      valMax_ = valMax;
+      if (!cache_.setInput(data, idx, dif) &&
+          !(recoveries_ && recover(data, idx, dif, ratio)))
+      {
+        return reject(data, idx, getCycles() - start);
+      }
+      enqueue(data, idx);
+    }
+    if (recoveries_)
+    {
+      recoveries_[idx].count = 0;
+    }
+    stamp.timestamp = timestamp;
+    stamp.flRun = true;
+    if (decimators_)
+    {
+      decimate(idx, timestamp);
+    }
+    return accept(idx, getCycles() - start);
+  }
+  inline void setInterval(unsigned long interval)
+  {
+    delete[] stamps_;
+    stamps_ = NULL;
+    interval_ = interval;
+    if (interval_)
+    {
+      stamps_ = new Stamp[getMeasures()]();
     }
-    valDif_ = (valDif < 0 ? -1 * valDif : valDif);
-    flGenMin_ = flGenMax_ = flGenDif_ = true;
   }
 
   /*
-    Initialization.
+    Recovery of a measure stuck by the valid difference
 
     DESCRIPTION:
-    The method initiates exponential filtering for statistical smoothing.
-    - It creates individual filter object for each data item provided.
-    - It should be called in the SETUP section of a sketch.
+    The method switches on or off the recovery of measures, which input
+    values are rejected just for exceeding the valid difference from the
+    recent accepted input value, e.g., after a genuine step of a signal.
+    - An input value within the valid range, which is rejected for the valid
+      difference, is accepted if it is the last one of a streak of (samples)
+      consecutive rejected input values, in which each one is within the
+      valid difference from the previous one. The smoother continues from it
+      and the next input values are checked against it.
+    - An accepted input value or an input value out of the valid range break
+      the streak of a measure.
+    - The recovery is evaluated just for rejected input values, so that
+      processing of valid input values is not affected.
+    - The recovery is reset by the method begin(), so that the method
+      setRecovery() should be called after it.
 
     PARAMETERS:
-    measures - Number of measures to be filtered, which means number of used
-    smoothers. It initiates (defines) valid measures range.
-    - Data type: positive integer
-    - Default value: 1
-    - Limited range: 1 ~ 255
+    samples - Number of consecutive consistent rejected input values, after
+    which the recent one is accepted.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 255 (0 for no recovery)
+
+    RETURN: none
+  */
+  inline void setRecovery(byte samples)
+  {
+    delete[] recoveries_;
+    recoveries_ = NULL;
+    recovery_ = samples;
+    if (recovery_)
+    {
+      recoveries_ = new Recovery[getMeasures()]();
+    }
+  }
+
+  /*
+    Lazy evaluation of smoothed values
+
+    DESCRIPTION:
+    The method setLazy() switches the lazy evaluation on or off. In lazy mode
+    accepted input values are just checked and queued for each measure, while
+    the smoother of a measure is advanced by the whole batch of them when its
+    smoothed value is read, the queue of the measure is full, or the method
+    flush() is called.
+    - It saves evaluation of smoothed values, which are read much less often
+      than input values are provided, e.g., for measures sampled at high rate
+      and published periodically. Smoothers with specialized smoothing kernel
+      can fold the batch in one pass.
+    - The lazy evaluation is switched off by the method begin(), so that the
+      method setLazy() should be called after it.
+    - The smoothed value of a measure should be read by the thread, which
+      provides input values for it.
+    - The method flush() without the measure index evaluates all measures.
+
+    PARAMETERS:
+    depth - Number of queued input values of a measure, which triggers
+    evaluation.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 255 (0 switches the lazy evaluation off)
+    idx - Index of a measure to be evaluated.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ (measures - 1)
+
+    RETURN: none
+  */
+  inline void setLazy(byte depth)
+  {
+    flush();
+    delete[] lazyData_;
+    delete[] lazyCount_;
+    lazyData_ = NULL;
+    lazyCount_ = NULL;
+    lazy_ = depth;
+    if (lazy_)
+    {
+      lazyData_ = new DAT[(size_t)getMeasures() * lazy_];
+      lazyCount_ = new byte[getMeasures()]();
+    }
+  }
+  inline void flush(IDX idx)
+  {
+    if (lazy_ && lazyCount_[idx])
+    {
+      cache_.setBatch(
+        lazyData_ + (size_t)idx * lazy_, lazyCount_[idx], idx);
+      lazyCount_[idx] = 0;
+    }
+  }
+  inline void flush()
+  {
+    for (IDX i = 0; lazy_ && i < getMeasures(); i++)
+    {
+      flush(i);
+    }
+  }
+
+  /*
+    Decimation of smoothed values
+
+    DESCRIPTION:
+    The methods set or reset the decimation of a measure, i.e., the output
+    stage, which passes the smoothed value of the measure to the publisher
+    only when it is due instead of polling it by a sketch.
+    - The smoothed value is due after every (factor) accepted input values or
+      at the first accepted input value after (period) milliseconds since the
+      recent publishing, whichever comes first.
+    - The period is measured by timestamps of input values, if the nominal
+      sampling interval is set by the method setInterval(), otherwise by the
+      function millis(). It starts at the first accepted input value after
+      setting it, so that timestamps can have any origin.
+    - The publisher is a function, which gets the record with smoothed value,
+      measure index, and time of publishing. It can publish the record at once
+      or put it to a queue for batch publishing.
+    - States of decimation are allocated at the first setting of it, so that
+      measures without decimation do not consume memory and processing time.
+    - If there is no measure index provided, the corresponding method acts
+      on all measures in cache.
+    - The decimation is reset by the method begin(), so that the methods
+      should be called after it.
+
+    PARAMETERS:
+    handler - Pointer to a publisher function.
+      - Data type: Publisher
+      - Default value: none
+    factor - Number of accepted input values per one published value.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 65535 (0 for no decimation by count)
+    period - Time period between published values in milliseconds.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ 2^32 - 1 (0 for no decimation by time)
+    idx - Index of a measure to be decimated.
+      - Data type: non-negative integer
+      - Default value: none
+      - Limited range: 0 ~ (measures - 1)
+
+    RETURN: none
+  */
+  struct Output
+  {
+    DAT value;
+    unsigned long timestamp;
+    IDX idx;
+  };
+  typedef void (*Publisher)(const Output &output);
+  inline void setPublisher(Publisher handler) { publisher_ = handler; }
+  inline void setDecimation(unsigned int factor, IDX idx)
+  {
+    Decimator &decimator = getDecimator(idx);
+    decimator.factor = factor;
+    decimator.count = 0;
+  }
+  inline void setDecimation(unsigned int factor)
+  {
+    for (IDX i = 0; i < getMeasures(); i++)
+    {
+      setDecimation(factor, i);
+    }
+  }
+  inline void setPeriod(unsigned long period, IDX idx)
+  {
+    Decimator &decimator = getDecimator(idx);
+    decimator.period = period;
+    decimator.flRun = false;
+  }
+  inline void setPeriod(unsigned long period)
+  {
+    for (IDX i = 0; i < getMeasures(); i++)
+    {
+      setPeriod(period, i);
+    }
+  }
+  inline void resetDecimation(IDX idx)
+  {
+    if (decimators_)
+    {
+      decimators_[idx].factor = 0;
+      decimators_[idx].period = 0;
+    }
+  }
+  inline void resetDecimation()
+  {
+    for (IDX i = 0; i < getMeasures(); i++)
+    {
+      resetDecimation(i);
+    }
+  }
+
+  /*
+    Calculate new smoothed values for all measures at once
+
+    DESCRIPTION:
+    The method checks and smooths a whole frame of input values, one for each
+    measure in order of their indices, in one pass.
+    - It is equivalent to calling the method setValue() for all measures, but
+      without per call overhead.
+    - Flags determining whether an input value has been accepted are packed
+      in a bitmask, where bit (idx % 8) of byte (idx / 8) belongs to the
+      measure with index idx.
+    - Bits of the bitmask beyond the number of measures are kept intact.
+
+    PARAMETERS:
+    data - Pointer to an array of input values to be smoothed.
+      - Data type: pointer to templated
+      - Limited range: array of (measures) items
+    valid - Pointer to an array for storing the bitmask of acceptance flags.
+      - Data type: pointer to non-negative integer
+      - Default value: NULL (bitmask is not stored)
+      - Limited range: array of ((measures + 7) / 8) items
+
+    RETURN:
+    Number of accepted input values.
+  */
+  inline IDX setValues(const DAT *data, byte *valid = NULL)
+  {
+    return update(data, valid, 0, getMeasures());
+  }
+
+  /*
+    Calculate new smoothed values for a shard of measures
+
+    DESCRIPTION:
+    The method checks and smooths a range of measures of a whole frame of
+    input values in the same way as the method setValues() for all measures.
+    - Ranges processed by different threads at the same time should start at
+      a multiple of 8 measures, because blocks of 8 measures share a byte of
+      flags. In the layouts gbj_appsmooth_soa and gbj_appsmooth_concurrent
+      ranges starting at a multiple of the shard size do not share cache
+      lines of smoothers and values with other ranges as well.
+    - Input values and the bitmask are indexed by measure indices, i.e., the
+      same arrays for the entire frame are provided for all shards of it.
+
+    PARAMETERS:
+    data - Pointer to an array of input values of the entire frame.
+      - Data type: pointer to templated
+      - Limited range: array of (measures) items
+    valid - Pointer to an array for storing the bitmask of acceptance flags.
+      - Data type: pointer to non-negative integer
+      - Limited range: array of ((measures + 7) / 8) items or NULL
+    first - Index of the first measure of the range.
+      - Data type: non-negative integer
+      - Limited range: 0 ~ (measures - 1)
+    count - Number of measures in the range.
+      - Data type: non-negative integer
+      - Limited range: 0 ~ (measures - first)
+
+    RETURN:
+    Number of accepted input values in the range.
+  */
+  inline IDX setValues(const DAT *data, byte *valid, IDX first, IDX count)
+  {
+    IDX measures = getMeasures();
+    if (first >= measures || count == 0)
+    {
+      return 0;
+    }
+    IDX last = count < measures - first ? first + count : measures;
+    return update(data, valid, first, last);
+  }
+
+  /*
+    Get number of measures in a shard
+
+    DESCRIPTION:
+    The method returns the least number of measures in whole bytes of flags,
+    which data of the layout fill whole cache lines. It is the unit of work
+    for processing of a frame by multiple threads.
+    - In the layout gbj_appsmooth_soa the arrays of smoothers and values start
+      at cache lines and shards end at them in all arrays.
+    - In the layout gbj_appsmooth_concurrent each record has its own cache
+      line, so that shards have just whole bytes of flags.
+
+    RETURN: Number of measures in a shard
+  */
+  inline IDX getShard() { return (IDX)Cache::getShard(); }
+
+  /*
+    Smooth samples queued by another thread or an interrupt
+
+    DESCRIPTION:
+    The method consumes samples from a single producer single consumer queue
+    in one batch and smooths them in order of their arrival.
+    - Samples of measures out of the valid measures range are ignored.
+    - The queue is released at once after the batch, so that the producer is
+      synchronized just once per batch.
+
+    PARAMETERS:
+    queue - Referenced queue of samples.
+      - Data type: gbj_appsmooth_queue with the same data and index types
+    limit - Maximal number of samples processed in the batch.
+      - Data type: non-negative integer
+      - Default value: 0 (all available samples)
+
+    RETURN:
+    Number of consumed samples.
+  */
+  template<class QUE>
+  inline unsigned int drain(QUE &queue, unsigned int limit = 0)
+  {
+    unsigned int count = queue.available();
+    if (limit && limit < count)
+    {
+      count = limit;
+    }
+    for (unsigned int i = 0; i < count; i++)
+    {
+      const typename QUE::Sample &sample = queue.peek(i);
+      if (sample.idx < getMeasures())
+      {
+        setValue(sample.value, sample.timestamp, sample.idx);
+      }
+    }
+    queue.release(count);
+    return count;
+  }
+
+#if !defined(__AVR__)
+  /*
+    Process a frame of input values by multiple threads
+
+    DESCRIPTION:
+    The methods split processing of a frame of input values into shards,
+    which are claimed dynamically by threads joining the processing, so that
+    threads finishing cheaper shards take over the remaining ones.
+    - The method beginFrame() prepares the frame for processing. It should be
+      called before any thread starts to process it.
+    - The method runFrame() is called by each worker thread. It processes
+      shards until no one is left.
+    - The method endFrame() is called by the thread, which has prepared the
+      frame. It takes part in processing and waits until all shards have been
+      processed by all threads.
+
+    PARAMETERS:
+    frame - Referenced structure with processing state of the frame.
+      - Data type: Frame of the same class template instance
+    data - Pointer to an array of input values of the entire frame.
+      - Data type: pointer to templated
+      - Limited range: array of (measures) items
+    valid - Pointer to an array for storing the bitmask of acceptance flags.
+      - Data type: pointer to non-negative integer
+      - Default value: NULL (bitmask is not stored)
+      - Limited range: array of ((measures + 7) / 8) items
 
-    RETURN: none
+    RETURN:
+    runFrame() - Flag determining whether the entire frame has been processed.
+    endFrame() - Number of accepted input values in the frame.
   */
-  inline void begin(byte measures = 1)
+  struct Frame
   {
-    measures_ = max((byte)1, measures);
-    smoothers_ = new Smoother[measures_];
-    for (byte i = 0; i < measures_; i++)
-    {
-      smoothers_[i].smoother = new SMT();
-      smoothers_[i].valueOutput = (DAT)smoothers_[i].smoother->getValue();
-      smoothers_[i].valueInput = smoothers_[i].valueOutput;
-      smoothers_[i].flRun = false;
-      smoothers_[i].flValid = true;
-    }
-    resetMinimum();
-    resetMaximum();
-    resetDifference();
-    // General valid range limits
-    if (flGenMin_)
-    {
-      setMinimum(valMin_);
-    }
-    if (flGenMax_)
+    const DAT *data;
+    byte *valid;
+    // First measure of the next shard to be claimed
+    std::atomic<IDX> next;
+    // Measures claimed but not processed yet and not claimed at all
+    std::atomic<IDX> pending;
+    std::atomic<IDX> accepted;
+  };
+  inline void beginFrame(Frame &frame, const DAT *data, byte *valid = NULL)
+  {
+    frame.data = data;
+    frame.valid = valid;
+    frame.accepted.store(0, std::memory_order_relaxed);
+    frame.pending.store(getMeasures(), std::memory_order_relaxed);
+    frame.next.store(0, std::memory_order_release);
+  }
+  inline bool runFrame(Frame &frame)
+  {
+    IDX shard = getShard();
+    IDX first = frame.next.load(std::memory_order_acquire);
+    while (first < getMeasures())
     {
-      setMaximum(valMax_);
+      IDX last =
+        shard < getMeasures() - first ? first + shard : getMeasures();
+      if (frame.next.compare_exchange_weak(first,
+                                           last,
+                                           std::memory_order_acquire,
+                                           std::memory_order_acquire))
+      {
+        frame.accepted.fetch_add(
+          update(frame.data, frame.valid, first, last),
+          std::memory_order_relaxed);
+        frame.pending.fetch_sub(last - first, std::memory_order_release);
+        first = last;
+      }
     }
-    if (flGenDif_)
+    return frame.pending.load(std::memory_order_acquire) == 0;
+  }
+  inline IDX endFrame(Frame &frame)
+  {
+    while (!runFrame(frame))
     {
-      setDifference(valDif_);
+      gbj_appsmooth_pause();
     }
+    return frame.accepted.load(std::memory_order_relaxed);
   }
+#endif
 
   /*
-    Calculate new smoothed value from provided input value and cache them both
+    Save and restore the state of all measures
 
     DESCRIPTION:
-    The method calculates a new filtered value from the input value for
-    a particular data smoother determined by the index.
-    - Input value as well as filtered value is cached in the smoother and can
-      be returned by corresponding getter.
+    The methods serialize the cached values, flags, and smoothers of all
+    measures to a compact binary buffer and restore them from it, e.g., for
+    warm restart of an application without convergence of smoothers.
+    - The buffer starts with the header of 12 bytes with the signature "GS",
+      version, byte order, sizes of data type and smoother, and number of
+      measures, all multibyte numbers in little-endian order.
+    - Each measure follows with input value, smoothed value, minimum,
+      maximum, valid difference, byte of flags, and raw bytes of the smoother,
+      all in the byte order stated in the header. The smoother should be
+      trivially copyable without pointers.
+    - The format is independent of the storage layout, so that the state can
+      be restored to an instance object with another layout.
+    - The state is restored to already initiated measures without any memory
+      allocation. It is rejected if the header does not match the instance
+      object or the platform.
+    - Input values queued by lazy evaluation are evaluated before saving.
+    - Settings of lazy evaluation, decimation, timestamps, and recovery are
+      not part of the state and they are kept at restoring. Their runtime
+      states, i.e., queued input values, timestamps of recent input values,
+      decimation counters, and recovery streaks, start again at restoring.
 
     PARAMETERS:
-    data - Input value to be smoothed.
-      - Data type: templated
-    idx - Index or sequence order of a measure which value should be smoothed
-      counting from zero.
+    buffer - Pointer to a buffer for the state.
+      - Data type: pointer to non-negative integer
+    size - Size of the buffer in bytes.
       - Data type: non-negative integer
-      - Default value: 0
-      - Limited range: 0 ~ (measures - 1)
+      - Limited range: getStateSize() ~ maximal size_t
 
     RETURN:
-    Flag determining whether input value has been accepted.
+    getStateSize() - Size of the state in bytes.
+    saveState() - Number of written bytes or 0 if the buffer is too small.
+    loadState() - Flag determining whether the state has been restored.
   */
-  inline bool setValue(DAT data, byte idx = 0)
+  inline size_t getStateSize()
+  {
+    return STATE_HEADER + (size_t)getMeasures() * STATE_RECORD;
+  }
+  size_t saveState(byte *buffer, size_t size)
+  {
+    if (size < getStateSize())
+    {
+      return 0;
+    }
+    flush();
+    setHeader(buffer, 'S', 0);
+    buffer += STATE_HEADER;
+    for (IDX i = 0; i < getMeasures(); i++)
+    {
+      DAT values[5] = { cache_.getInput(i),   cache_.getValue(i),
+                        cache_.getMinimum(i), cache_.getMaximum(i),
+                        cache_.getDifference(i) };
+      memcpy(buffer, values, sizeof(values));
+      buffer[sizeof(values)] = cache_.getFlags(i);
+      memcpy(buffer + sizeof(values) + 1, cache_.getSmoother(i), sizeof(SMT));
+      buffer += STATE_RECORD;
+    }
+    return getStateSize();
+  }
+  bool loadState(const byte *buffer, size_t size)
   {
-    return smoothers_[idx].setValue(data);
+    byte header[STATE_HEADER];
+    setHeader(header, 'S', 0);
+    if (size < getStateSize() || memcmp(buffer, header, STATE_HEADER))
+    {
+      return false;
+    }
+    restart();
+    buffer += STATE_HEADER;
+    for (IDX i = 0; i < getMeasures(); i++)
+    {
+      DAT values[5];
+      memcpy(values, buffer, sizeof(values));
+      cache_.setRecord(values, buffer[sizeof(values)], i);
+      memcpy(cache_.getSmoother(i), buffer + sizeof(values) + 1, sizeof(SMT));
+      buffer += STATE_RECORD;
+    }
+    return true;
   }
 
   /*
@@ -179,69 +2324,109 @@ public:
 
     RETURN: Filtering result flag
   */
-  inline void setMinimum(DAT data, byte idx)
+  inline void setMinimum(DAT data, IDX idx)
   {
-    smoothers_[idx].minimum = data;
-    smoothers_[idx].flMin = true;
+    cache_.setMinimum(data, idx);
   }
   inline void setMinimum(DAT data)
   {
-    for (byte i = 0; i < getMeasures(); i++)
+    for (IDX i = 0; i < getMeasures(); i++)
     {
       setMinimum(data, i);
     }
   }
-  inline void resetMinimum(byte idx) { smoothers_[idx].flMin = false; }
+  inline void resetMinimum(IDX idx) { cache_.resetMinimum(idx); }
   inline void resetMinimum()
   {
-    for (byte i = 0; i < getMeasures(); i++)
+    for (IDX i = 0; i < getMeasures(); i++)
     {
       resetMinimum(i);
     }
   }
-  inline void setMaximum(DAT data, byte idx)
+  inline void setMaximum(DAT data, IDX idx)
   {
-    smoothers_[idx].maximum = data;
-    smoothers_[idx].flMax = true;
+    cache_.setMaximum(data, idx);
   }
   inline void setMaximum(DAT data)
   {
-    for (byte i = 0; i < getMeasures(); i++)
+    for (IDX i = 0; i < getMeasures(); i++)
     {
       setMaximum(data, i);
     }
   }
-  inline void resetMaximum(byte idx) { smoothers_[idx].flMax = false; }
+  inline void resetMaximum(IDX idx) { cache_.resetMaximum(idx); }
   inline void resetMaximum()
   {
-    for (byte i = 0; i < getMeasures(); i++)
+    for (IDX i = 0; i < getMeasures(); i++)
     {
       resetMaximum(i);
     }
   }
-  inline void setDifference(DAT data, byte idx)
+  inline void setDifference(DAT data, IDX idx)
   {
-    smoothers_[idx].difference = data;
-    smoothers_[idx].flDif = true;
+    cache_.setDifference(data, idx);
   }
   inline void setDifference(DAT data)
   {
-    for (byte i = 0; i < getMeasures(); i++)
+    for (IDX i = 0; i < getMeasures(); i++)
     {
       setDifference(data, i);
     }
   }
-  inline void resetDifference(byte idx) { smoothers_[idx].flDif = false; }
+  inline void resetDifference(IDX idx) { cache_.resetDifference(idx); }
   inline void resetDifference()
   {
-    for (byte i = 0; i < getMeasures(); i++)
+    for (IDX i = 0; i < getMeasures(); i++)
     {
       resetDifference(i);
     }
   }
 
+#if defined(GBJ_APPSMOOTH_STATS)
+  /*
+    Statistics of processing of input values
+
+    DESCRIPTION:
+    The statistics are available only if the macro GBJ_APPSMOOTH_STATS is
+    defined before including the library. Otherwise there is neither any
+    memory nor any code for them.
+    - Statistics of all measures are one contiguous array indexed by measure
+      indices, which is allocated and reset by the method begin().
+    - A rejected input value is counted for the first failed check in order
+      minimum, maximum, and difference.
+    - The streak is the number of consecutive rejected input values since the
+      recent accepted one.
+    - Cycles are the accumulated processor cycles of processing of input
+      values, if the macro GBJ_APPSMOOTH_STATS_TIMING is defined as well.
+      Cycles of a frame are spread evenly among its measures.
+
+    PARAMETERS:
+    idx - Measure index counting from zero.
+      - Data type: non-negative integer
+      - Limited range: 0 ~ (measures - 1)
+
+    RETURN: Statistics of a measure or pointer to statistics of all measures.
+  */
+  struct Stats
+  {
+    unsigned long accepted;
+    unsigned long rejectedMin;
+    unsigned long rejectedMax;
+    unsigned long rejectedDif;
+    unsigned long streak;
+    unsigned long streakMax;
+    unsigned long cycles;
+  };
+  inline const Stats &getStats(IDX idx) { return stats_[idx]; }
+  inline const Stats *getStats() { return stats_; }
+  inline void resetStats()
+  {
+    memset(stats_, 0, sizeof(Stats) * getMeasures());
+  }
+#endif
+
   // Getters
-  inline byte getMeasures() { return measures_; }
+  inline IDX getMeasures() { return CNT ? CNT : measures_; }
 
   /*
     Get pointer to the smoother for particular measure
@@ -259,7 +2444,11 @@ public:
 
     RETURN: Pointer to smoother or NULL
   */
-  inline SMT *getMeasurePtr(byte idx = 0) { return smoothers_[idx].smoother; }
+  inline SMT *getMeasurePtr(IDX idx = 0)
+  {
+    flush(idx);
+    return cache_.getSmoother(idx);
+  }
 
   /*
     Get characteristic value for particular measure
@@ -275,70 +2464,576 @@ public:
 
     RETURN: Measure value or NaN
   */
-  inline DAT getValue(byte idx = 0) { return smoothers_[idx].valueOutput; }
-  inline DAT getInput(byte idx = 0) { return smoothers_[idx].valueInput; }
-  inline DAT getMinimum(byte idx = 0) { return smoothers_[idx].minimum; }
-  inline DAT getMaximum(byte idx = 0) { return smoothers_[idx].maximum; }
-  inline DAT getDifference(byte idx = 0) { return smoothers_[idx].difference; }
-  inline bool isValid(byte idx = 0) { return smoothers_[idx].flValid; }
-  inline bool isInvalid(byte idx = 0) { return !isValid(idx); }
+  inline DAT getValue(IDX idx = 0)
+  {
+    flush(idx);
+    return cache_.getValue(idx);
+  }
+  inline DAT getInput(IDX idx = 0) { return cache_.getInput(idx); }
+  inline DAT getMinimum(IDX idx = 0) { return cache_.getMinimum(idx); }
+  inline DAT getMaximum(IDX idx = 0) { return cache_.getMaximum(idx); }
+  inline DAT getDifference(IDX idx = 0) { return cache_.getDifference(idx); }
+  inline bool isValid(IDX idx = 0) { return cache_.isValid(idx); }
+  inline bool isInvalid(IDX idx = 0) { return !isValid(idx); }
+
+  /*
+    Get consistent snapshot of smoothed value and its validity
+
+    DESCRIPTION:
+    The method returns smoothed value and validity flag of a measure from the
+    same update, even if the measure is being updated by another thread.
+    - It is available just for the layout gbj_appsmooth_concurrent.
+    - Different measures can be updated by different threads without locks,
+      but each measure should be updated just by one thread at a time.
+    - Just the snapshot and getters getValue() and isValid() based on it are
+      safe for other threads than the updating one. Limits, input values,
+      smoothers, and lazy evaluation, which flushes queued input values at
+      reading, belong to the updating thread.
+
+    PARAMETERS:
+    value - Referenced variable for placing the smoothed value.
+      - Data type: templated
+    idx - Measure index which value should be returned counting from zero.
+      - Data type: non-negative integer
+      - Default value: 0
+      - Limited range: 0 ~ (measures - 1)
+
+    RETURN: Flag determining validity of the recent input value.
+  */
+  inline bool getSnapshot(DAT &value, IDX idx = 0)
+  {
+    flush(idx);
+    return cache_.getSnapshot(value, idx);
+  }
+
+protected:
+  // Copy of measures with their settings to the cache initiated already
+  // with the same number of measures or to own dynamically allocated one
+  void assign(const gbj_appsmooth &other)
+  {
+    // Getters of the cache are used for reading only
+    gbj_appsmooth &source = const_cast<gbj_appsmooth &>(other);
+    valMin_ = source.valMin_;
+    valMax_ = source.valMax_;
+    valDif_ = source.valDif_;
+    flGenMin_ = source.flGenMin_;
+    flGenMax_ = source.flGenMax_;
+    flGenDif_ = source.flGenDif_;
+    if (!CNT)
+    {
+      if (!source.measures_)
+      {
+        release();
+        measures_ = 0;
+        return;
+      }
+      begin(source.measures_);
+    }
+    IDX measures = getMeasures();
+    for (IDX i = 0; i < measures; i++)
+    {
+      DAT values[5] = {
+        source.cache_.getInput(i),   source.cache_.getValue(i),
+        source.cache_.getMinimum(i), source.cache_.getMaximum(i),
+        source.cache_.getDifference(i),
+      };
+      cache_.setRecord(values, source.cache_.getFlags(i), i);
+      *cache_.getSmoother(i) = *source.cache_.getSmoother(i);
+    }
+    lazy_ = source.lazy_;
+    lazyData_ = clone(source.lazyData_, (size_t)measures * lazy_);
+    lazyCount_ = clone(source.lazyCount_, measures);
+    decimators_ = clone(source.decimators_, measures);
+    publisher_ = source.publisher_;
+    interval_ = source.interval_;
+    stamps_ = clone(source.stamps_, measures);
+    recovery_ = source.recovery_;
+    recoveries_ = clone(source.recoveries_, measures);
+#if defined(GBJ_APPSMOOTH_STATS)
+    delete[] stats_;
+    stats_ = clone(source.stats_, measures);
+#endif
+  }
 
 private:
-  struct Smoother
-  {
-    DAT valueInput;
-    DAT valueOutput;
-    DAT minimum;
-    DAT maximum;
-    DAT difference;
-    // Should be after DAT members
-    SMT *smoother;
-    // Test for minimum if true
-    bool flMin;
-    // Test for maximum if true
-    bool flMax;
-    // Test for difference if true
-    bool flDif;
-    // Running after initialization
+  // Persistent state format
+  static const byte STATE_VERSION = 1;
+  static const size_t STATE_HEADER = 12;
+  static const size_t STATE_RECORD = 5 * sizeof(DAT) + 1 + sizeof(SMT);
+  static const size_t MAP_HEADER = STATE_HEADER + 4;
+  static inline size_t getMapOffset()
+  {
+    return (MAP_HEADER + Cache::ALIGN - 1) / Cache::ALIGN * Cache::ALIGN;
+  }
+  // Cache of measures in the layout
+  Cache cache_;
+  // Number of used measures
+  IDX measures_ = 0;
+  // General range and difference limits
+  DAT valMin_ = DAT(), valMax_ = DAT(), valDif_ = DAT();
+  // Flags about general limits (without initialization interpreted as 255)
+  bool flGenMin_ = false;
+  bool flGenMax_ = false;
+  bool flGenDif_ = false;
+  // Lazy evaluation depth and queues of accepted input values of measures
+  byte lazy_ = 0;
+  DAT *lazyData_ = NULL;
+  byte *lazyCount_ = NULL;
+  // Decimation states of measures allocated on demand
+  struct Decimator
+  {
+    unsigned int factor;
+    unsigned int count;
+    unsigned long period;
+    unsigned long timestamp;
+    bool flRun;
+  };
+  Decimator *decimators_ = NULL;
+  Publisher publisher_ = NULL;
+  // Nominal sampling interval and timestamps of recent accepted input values
+  struct Stamp
+  {
+    unsigned long timestamp;
     bool flRun;
-    // Input accepted
-    bool flValid;
-    bool setValue(DAT val)
+  };
+  unsigned long interval_ = 0;
+  Stamp *stamps_ = NULL;
+  // Recovery depth and streaks of consistent rejected input values
+  struct Recovery
+  {
+    DAT value;
+    byte count;
+  };
+  byte recovery_ = 0;
+  Recovery *recoveries_ = NULL;
+#if defined(GBJ_APPSMOOTH_STATS)
+  // Statistics of measures
+  Stats *stats_ = NULL;
+#endif
+
+  // Release of all allocated memory
+  void release()
+  {
+    delete[] lazyData_;
+    delete[] lazyCount_;
+    lazyData_ = NULL;
+    lazyCount_ = NULL;
+    lazy_ = 0;
+    freeDecimation();
+    setInterval(0);
+    setRecovery(0);
+#if defined(GBJ_APPSMOOTH_STATS)
+    delete[] stats_;
+    stats_ = NULL;
+#endif
+    cache_.end();
+  }
+  // Transfer of all members leaving the source without measures and memory
+  void take(gbj_appsmooth &other)
+  {
+    cache_ = other.cache_;
+    other.cache_ = Cache();
+    measures_ = other.measures_;
+    other.measures_ = 0;
+    valMin_ = other.valMin_;
+    valMax_ = other.valMax_;
+    valDif_ = other.valDif_;
+    flGenMin_ = other.flGenMin_;
+    flGenMax_ = other.flGenMax_;
+    flGenDif_ = other.flGenDif_;
+    lazy_ = other.lazy_;
+    lazyData_ = other.lazyData_;
+    lazyCount_ = other.lazyCount_;
+    other.lazy_ = 0;
+    other.lazyData_ = NULL;
+    other.lazyCount_ = NULL;
+    decimators_ = other.decimators_;
+    publisher_ = other.publisher_;
+    other.decimators_ = NULL;
+    interval_ = other.interval_;
+    stamps_ = other.stamps_;
+    other.interval_ = 0;
+    other.stamps_ = NULL;
+    recovery_ = other.recovery_;
+    recoveries_ = other.recoveries_;
+    other.recovery_ = 0;
+    other.recoveries_ = NULL;
+#if defined(GBJ_APPSMOOTH_STATS)
+    stats_ = other.stats_;
+    other.stats_ = NULL;
+#endif
+  }
+  template<typename T>
+  static T *clone(const T *source, size_t count)
+  {
+    if (!source)
+    {
+      return NULL;
+    }
+    T *target = new T[count];
+    for (size_t k = 0; k < count; k++)
+    {
+      target[k] = source[k];
+    }
+    return target;
+  }
+
+  // Header of persistent state of a kind and a layout
+  void setHeader(byte *header, char kind, byte layout)
+  {
+    const unsigned int order = 1;
+    unsigned long measures = getMeasures();
+    header[0] = 'G';
+    header[1] = kind;
+    header[2] = STATE_VERSION;
+    // Big-endian platform
+    header[3] = *reinterpret_cast<const byte *>(&order) ? 0 : 1;
+    header[4] = sizeof(DAT);
+    header[5] = layout;
+    header[6] = sizeof(SMT) & 0xFF;
+    header[7] = (sizeof(SMT) >> 8) & 0xFF;
+    for (byte k = 0; k < 4; k++)
+    {
+      header[8 + k] = (measures >> (8 * k)) & 0xFF;
+    }
+  }
+
+  inline void enqueue(DAT data, IDX idx)
+  {
+    lazyData_[(size_t)idx * lazy_ + lazyCount_[idx]] = data;
+    if (++lazyCount_[idx] == lazy_)
+    {
+      flush(idx);
+    }
+  }
+
+  // Discarding of runtime states of measures superseded by restored state
+  inline void restart()
+  {
+    for (IDX i = 0; i < getMeasures(); i++)
     {
-      // Test
-      flValid = true;
-      if (flMin && val < minimum)
+      if (lazy_)
       {
-        flValid = false;
+        lazyCount_[i] = 0;
       }
-      else if (flMax && val > maximum)
+      if (stamps_)
       {
-        flValid = false;
+        stamps_[i].flRun = false;
       }
-      else if (flRun && flDif && valAbs(val - valueInput) > difference)
+      if (recoveries_)
       {
-        flValid = false;
+        recoveries_[i].count = 0;
       }
-      // Evaluation
-      if (flValid)
+      if (decimators_)
       {
-        flRun = true;
-        valueInput = val;
-        valueOutput = (DAT)smoother->getValue((DAT)val);
+        decimators_[i].count = 0;
+        decimators_[i].flRun = false;
       }
-      return flValid;
     }
-    DAT valAbs(DAT data) { return data < 0 ? -1 * data : data; }
-  };
-  // Number of used measures
-  Smoother *smoothers_;
-  byte measures_;
-  // General range and difference limits
-  DAT valMin_, valMax_, valDif_;
-  // Flags about general limits (without initialization interpreted as 255)
-  bool flGenMin_ = false;
-  bool flGenMax_ = false;
-  bool flGenDif_ = false;
+  }
+
+  inline Decimator &getDecimator(IDX idx)
+  {
+    if (!decimators_)
+    {
+      decimators_ = new Decimator[getMeasures()]();
+    }
+    return decimators_[idx];
+  }
+  inline void freeDecimation()
+  {
+    delete[] decimators_;
+    decimators_ = NULL;
+  }
+  // Publishing of the accepted input value's measure if it is due
+  void decimate(IDX idx, unsigned long now)
+  {
+    Decimator &decimator = decimators_[idx];
+    if (!(decimator.factor || decimator.period))
+    {
+      return;
+    }
+    // Period starts at the first accepted input value in its time base
+    if (!decimator.flRun)
+    {
+      decimator.timestamp = now;
+      decimator.flRun = true;
+    }
+    if ((decimator.factor && ++decimator.count >= decimator.factor) ||
+        (decimator.period && now - decimator.timestamp >= decimator.period))
+    {
+      decimator.count = 0;
+      decimator.timestamp = now;
+      if (publisher_)
+      {
+        Output output = { getValue(idx), now, idx };
+        publisher_(output);
+      }
+    }
+  }
+
+  // Acceptance of a rejected input value at the end of a consistent streak
+  bool recover(DAT data, IDX idx, DAT dif, float ratio)
+  {
+    Recovery &recovery = recoveries_[idx];
+    byte flags = cache_.getFlags(idx);
+    if (((flags & GBJ_APPSMOOTH_FLAG_MIN) && data < cache_.getMinimum(idx)) ||
+        ((flags & GBJ_APPSMOOTH_FLAG_MAX) && data > cache_.getMaximum(idx)))
+    {
+      recovery.count = 0;
+      return false;
+    }
+    DAT change = data - recovery.value;
+    change = change < 0 ? -1 * change : change;
+    recovery.count = recovery.count && !(change > dif) ? recovery.count + 1 : 1;
+    recovery.value = data;
+    if (recovery.count < recovery_)
+    {
+      return false;
+    }
+    recovery.count = 0;
+    change = data - cache_.getInput(idx);
+    change = change < 0 ? -1 * change : change;
+    return lazy_ ? cache_.setInput(data, idx, change)
+                 : cache_.setValue(data, idx, change, ratio);
+  }
+
+  // Statistics hooks, which are empty without statistics
+  inline void beginStats()
+  {
+#if defined(GBJ_APPSMOOTH_STATS)
+    delete[] stats_;
+    stats_ = new Stats[getMeasures()]();
+#endif
+  }
+  static inline unsigned long getCycles()
+  {
+#if defined(GBJ_APPSMOOTH_STATS_TIMING) && defined(GBJ_APPSMOOTH_STATS)
+    return gbj_appsmooth_cycles();
+#else
+    return 0;
+#endif
+  }
+  inline bool accept(IDX idx, unsigned long cycles)
+  {
+#if defined(GBJ_APPSMOOTH_STATS)
+    Stats &stats = stats_[idx];
+    stats.accepted++;
+    stats.streak = 0;
+    stats.cycles += cycles;
+#else
+    (void)idx;
+    (void)cycles;
+#endif
+    return true;
+  }
+  inline bool reject(DAT data, IDX idx, unsigned long cycles)
+  {
+#if defined(GBJ_APPSMOOTH_STATS)
+    Stats &stats = stats_[idx];
+    byte flags = cache_.getFlags(idx);
+    if ((flags & GBJ_APPSMOOTH_FLAG_MIN) && data < cache_.getMinimum(idx))
+    {
+      stats.rejectedMin++;
+    }
+    else if ((flags & GBJ_APPSMOOTH_FLAG_MAX) && data > cache_.getMaximum(idx))
+    {
+      stats.rejectedMax++;
+    }
+    else
+    {
+      stats.rejectedDif++;
+    }
+    stats.streak++;
+    stats.streakMax = gbj_appsmooth_max(stats.streak, stats.streakMax);
+    stats.cycles += cycles;
+#else
+    (void)data;
+    (void)idx;
+    (void)cycles;
+#endif
+    return false;
+  }
+  inline void count(const DAT *data, IDX first, IDX last, unsigned long start)
+  {
+#if defined(GBJ_APPSMOOTH_STATS)
+    unsigned long cycles = (getCycles() - start) / (last - first);
+    for (IDX i = first; i < last; i++)
+    {
+      cache_.isValid(i) ? accept(i, cycles) : reject(data[i], i, cycles);
+    }
+#else
+    (void)data;
+    (void)first;
+    (void)last;
+    (void)start;
+#endif
+  }
+
+  // Processing of a range of measures of a frame
+  IDX update(const DAT *data, byte *valid, IDX first, IDX last)
+  {
+    if (!lazy_)
+    {
+      unsigned long start = getCycles();
+      IDX accepted = cache_.setValues(data, valid, first, last);
+      for (IDX i = first; recoveries_ && i < last; i++)
+      {
+        if (cache_.isValid(i))
+        {
+          recoveries_[i].count = 0;
+        }
+        else if (recover(data[i], i, cache_.getDifference(i), 1.0))
+        {
+          accepted++;
+          if (valid)
+          {
+            valid[i >> 3] |= 1 << (i & 7);
+          }
+        }
+      }
+      count(data, first, last, start);
+      for (IDX i = first; decimators_ && i < last; i++)
+      {
+        if (cache_.isValid(i))
+        {
+          decimate(i, millis());
+        }
+      }
+      return accepted;
+    }
+    IDX accepted = 0;
+    byte mask = 0, range = 0;
+    for (IDX i = first; i < last; i++)
+    {
+      range |= 1 << (i & 7);
+      if (setValue(data[i], i))
+      {
+        mask |= 1 << (i & 7);
+        accepted++;
+      }
+      if ((i & 7) == 7 || i == last - 1)
+      {
+        // Flags of measures out of range are kept intact
+        if (valid)
+        {
+          valid[i >> 3] = (valid[i >> 3] & ~range) | mask;
+        }
+        mask = range = 0;
+      }
+    }
+    return accepted;
+  }
+
+  void init()
+  {
+    resetMinimum();
+    resetMaximum();
+    resetDifference();
+    // General valid range limits
+    if (flGenMin_)
+    {
+      setMinimum(valMin_);
+    }
+    if (flGenMax_)
+    {
+      setMaximum(valMax_);
+    }
+    if (flGenDif_)
+    {
+      setDifference(valDif_);
+    }
+  }
+};
+
+// Smallest index type for a number of measures
+template<bool WIDE>
+struct gbj_appsmooth_index
+{
+  typedef byte type;
+};
+template<>
+struct gbj_appsmooth_index<true>
+{
+  typedef unsigned int type;
+};
+
+/*
+  Application library with compile-time number of measures
+
+  DESCRIPTION:
+  The class template is the variant of the application library for a fixed
+  number of measures known at compile time.
+  - The cache of measures is a member of the instance object, so that no
+    memory is allocated dynamically at all.
+  - The cache is initiated already by the constructor, so that the method
+    begin() without arguments is needed only for repeated initialization.
+  - The number of measures is a constant for the compiler, so that it can
+    unroll loops over all measures.
+  - The index type is selected automatically as the smallest one for the
+    number of measures.
+
+  PARAMETERS:
+  N - Number of measures.
+    - Data type: positive integer
+    - Limited range: 1 ~ maximal unsigned integer
+*/
+template<class SMT,
+         typename DAT = float,
+         unsigned int N = 1,
+         class LAY = gbj_appsmooth_aos>
+class gbj_appsmooth_fixed
+  : public gbj_appsmooth<SMT,
+                         DAT,
+                         LAY,
+                         typename gbj_appsmooth_index<(N > 255)>::type,
+                         N>
+{
+  typedef gbj_appsmooth<SMT,
+                        DAT,
+                        LAY,
+                        typename gbj_appsmooth_index<(N > 255)>::type,
+                        N>
+    Base;
+
+public:
+  inline gbj_appsmooth_fixed() { begin(); }
+  inline gbj_appsmooth_fixed(DAT valMax)
+    : Base(valMax)
+  {
+    begin();
+  }
+  inline gbj_appsmooth_fixed(DAT valMax, DAT valMin)
+    : Base(valMax, valMin)
+  {
+    begin();
+  }
+  inline gbj_appsmooth_fixed(DAT valMax, DAT valMin, DAT valDif)
+    : Base(valMax, valMin, valDif)
+  {
+    begin();
+  }
+  // Copy keeps the cache in its own storage
+  inline gbj_appsmooth_fixed(const gbj_appsmooth_fixed &other)
+    : Base()
+  {
+    begin();
+    Base::assign(other);
+  }
+  inline gbj_appsmooth_fixed &operator=(const gbj_appsmooth_fixed &other)
+  {
+    if (this != &other)
+    {
+      begin();
+      Base::assign(other);
+    }
+    return *this;
+  }
+
+  inline void begin() { Base::begin(buffer_); }
+
+private:
+  typename Base::template Buffer<N> buffer_;
 };
 
 #endif
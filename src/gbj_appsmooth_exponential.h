@@ -0,0 +1,182 @@
+/*
+  NAME:
+  gbj_appsmooth_exponential
+
+  DESCRIPTION:
+  Built-in exponential filtering for the application library gbj_appsmooth.
+  - The smoother is just a compact state of a measure, while the algorithm is
+    provided by the specialization of the smoothing kernel, so that all
+    measures are smoothed in one pass without calls of a generic library.
+  - The interface of the smoother is the same as of the generic library
+    gbj_exponential and results are identical with it.
+  - For timestamped input values the smoothing factor is adjusted to the
+    elapsed time, so that a sample after k nominal sampling intervals has the
+    same weight as k samples would have. The logarithm of the factor's
+    complement is calculated just at setting the factor and the power of it
+    is interpolated from a table, so that there is no transcendental function
+    called for a sample.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_appsmooth.git
+*/
+#ifndef GBJ_APPSMOOTH_EXPONENTIAL_H
+#define GBJ_APPSMOOTH_EXPONENTIAL_H
+
+#include "gbj_appsmooth.h"
+#include <math.h>
+
+struct gbj_appsmooth_exponential
+{
+  static constexpr float FACTOR_DEF = 0.5;
+  static constexpr float FACTOR_MIN = 0.0;
+  static constexpr float FACTOR_MAX = 1.0;
+
+  float value;
+  float factor;
+  // Binary logarithm of the complement of the factor negated
+  float decay;
+  // Smoothing after the first sample
+  bool flRun;
+
+  inline gbj_appsmooth_exponential()
+    : value(0.0)
+    , factor(FACTOR_DEF)
+    , decay(1.0)
+    , flRun(false)
+  {
+  }
+
+  /*
+    Set smoothing factor of the measure
+
+    PARAMETERS:
+    factor - Smoothing factor, i.e., weight of a new sample.
+      - Data type: float
+      - Default value: 0.5
+      - Limited range: 0.0 ~ 1.0
+
+    RETURN: none
+  */
+  inline void setFactor(float data = FACTOR_DEF)
+  {
+    factor = data < FACTOR_MIN ? FACTOR_MIN
+                               : (data > FACTOR_MAX ? FACTOR_MAX : data);
+    decay = factor < FACTOR_MAX ? -log(1.0 - factor) / log(2.0) : 0.0;
+  }
+  inline float getFactor() { return factor; }
+
+  /*
+    Get smoothing factor for a sample after elapsed time
+
+    PARAMETERS:
+    ratio - Elapsed time since the recent sample in nominal sampling
+    intervals.
+      - Data type: float
+      - Limited range: non-negative
+
+    RETURN: Effective smoothing factor 1 - (1 - factor)^ratio
+  */
+  inline float getFactor(float ratio)
+  {
+    if (ratio == 1.0 || factor <= FACTOR_MIN || factor >= FACTOR_MAX)
+    {
+      return factor;
+    }
+    // Power 2^(-x) split to integer and fractional parts of exponent
+    float x = ratio * decay * 16;
+    if (!(x < 16 * 120))
+    {
+      return FACTOR_MAX;
+    }
+    unsigned int k = (unsigned int)x;
+    float fraction = x - k;
+    float lo = getPower(k & 15);
+    float hi = getPower((k & 15) + 1);
+    return FACTOR_MAX - ldexp(lo + fraction * (hi - lo), -(int)(k >> 4));
+  }
+
+  // Same getters as the generic library has
+  inline float getValue() { return value; }
+  inline float getValue(float data)
+  {
+    value = flRun ? value + factor * (data - value) : data;
+    flRun = true;
+    return value;
+  }
+
+private:
+  // Powers 2^(-k/16) for interpolation
+  static inline float getPower(byte k)
+  {
+    static const float POWERS[17] = {
+      1.0000000, 0.9576033, 0.9170040, 0.8781261, 0.8408964, 0.8052452,
+      0.7711054, 0.7384131, 0.7071068, 0.6771278, 0.6484198, 0.6209289,
+      0.5946036, 0.5693943, 0.5452539, 0.5221369, 0.5000000,
+    };
+    return POWERS[k];
+  }
+};
+
+template<typename DAT>
+struct gbj_appsmooth_kernel<gbj_appsmooth_exponential, DAT>
+{
+  static inline DAT getValue(gbj_appsmooth_exponential &smoother)
+  {
+    return (DAT)smoother.getValue();
+  }
+  static inline DAT getValue(gbj_appsmooth_exponential &smoother, DAT data)
+  {
+    return (DAT)smoother.getValue((float)data);
+  }
+  static inline DAT getValue(gbj_appsmooth_exponential &smoother,
+                             DAT data,
+                             float ratio)
+  {
+    float factor = smoother.getFactor(ratio);
+    float value = smoother.value;
+    smoother.value =
+      smoother.flRun ? value + factor * ((float)data - value) : (float)data;
+    smoother.flRun = true;
+    return (DAT)smoother.value;
+  }
+  // Branchless update of measures up to the highest flagged one
+  static inline void getValues(gbj_appsmooth_exponential *smoother,
+                               const DAT *data,
+                               DAT *output,
+                               byte mask)
+  {
+    for (byte k = 0; k < 8 && (mask >> k); k++)
+    {
+      bool flAccept = (mask >> k) & 1;
+      float value = smoother[k].value;
+      float input = (float)data[k];
+      float smooth = smoother[k].flRun
+                       ? value + smoother[k].factor * (input - value)
+                       : input;
+      smoother[k].value = flAccept ? smooth : value;
+      smoother[k].flRun |= flAccept;
+      output[k] = flAccept ? (DAT)smooth : output[k];
+    }
+  }
+  // Folding of a batch in the state kept in a register
+  static inline DAT getBatch(gbj_appsmooth_exponential &smoother,
+                             const DAT *data,
+                             byte count)
+  {
+    float value = smoother.flRun ? smoother.value : (float)data[0];
+    for (byte k = 0; k < count; k++)
+    {
+      value += smoother.factor * ((float)data[k] - value);
+    }
+    smoother.value = value;
+    smoother.flRun = true;
+    return (DAT)value;
+  }
+};
+
+#endif
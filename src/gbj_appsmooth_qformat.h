@@ -0,0 +1,265 @@
+/*
+  NAME:
+  gbj_appsmooth_qformat
+
+  DESCRIPTION:
+  Fixed-point data types in Q format for the application library
+  gbj_appsmooth and the built-in exponential filtering for them.
+  - A value is stored as a signed integer scaled by 2^F, so that all
+    arithmetic of checking and smoothing is integer one, which is essential
+    for platforms without floating point unit.
+  - Floating point numbers are converted to the type just at configuration,
+    e.g., for limits and smoothing factors, and explicitly for reading.
+  - The type with 32-bit integer has the same bit representation as int for
+    comparisons, so that the structure of arrays layout checks blocks of
+    measures by integer SIMD instructions on x86 platforms.
+  - The built-in exponential filtering for the type never touches floating
+    point and rounds results to nearest.
+  - The valid difference for timestamped input values is scaled in integer
+    arithmetic. However, the ratio of the elapsed time to the nominal
+    sampling interval for smoothing kernels is still one floating point
+    division per input value, which the built-in exponential filtering
+    ignores. Timestamped input values are not entirely free of floating point
+    arithmetic.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_appsmooth.git
+*/
+#ifndef GBJ_APPSMOOTH_QFORMAT_H
+#define GBJ_APPSMOOTH_QFORMAT_H
+
+#include "gbj_appsmooth.h"
+#include <stdint.h>
+
+// Integer types for intermediate results of the fixed-point arithmetic
+template<typename T>
+struct gbj_appsmooth_qwide;
+template<>
+struct gbj_appsmooth_qwide<int16_t>
+{
+  typedef int32_t type;
+  typedef uint16_t modular;
+};
+template<>
+struct gbj_appsmooth_qwide<int32_t>
+{
+  typedef int64_t type;
+  typedef uint32_t modular;
+};
+
+/*
+  PARAMETERS:
+  T - Signed integer type of the raw value.
+    - Data type: int16_t or int32_t
+  F - Number of fractional bits.
+    - Data type: positive integer
+    - Limited range: 1 ~ (bits of T - 2)
+*/
+template<typename T, byte F>
+struct gbj_appsmooth_q
+{
+  typedef typename gbj_appsmooth_qwide<T>::type Wide;
+  typedef typename gbj_appsmooth_qwide<T>::modular Modular;
+  static_assert(F > 0 && F < sizeof(T) * 8 - 1, "Wrong number of fractions");
+  static const T ONE = (T)1 << F;
+
+  T raw;
+
+  gbj_appsmooth_q() = default;
+  // Conversions at configuration
+  inline gbj_appsmooth_q(int data)
+    : raw((T)((Wide)data * ONE))
+  {
+  }
+  inline gbj_appsmooth_q(double data)
+    : raw((T)(data * ONE + (data < 0 ? -0.5 : 0.5)))
+  {
+  }
+  static inline gbj_appsmooth_q fromRaw(T data)
+  {
+    gbj_appsmooth_q result;
+    result.raw = data;
+    return result;
+  }
+  inline explicit operator float() const { return (float)raw / ONE; }
+  inline explicit operator double() const { return (double)raw / ONE; }
+
+  // Arithmetic wrapping around like in integer SIMD instructions
+  friend inline gbj_appsmooth_q operator+(gbj_appsmooth_q a, gbj_appsmooth_q b)
+  {
+    return fromRaw((T)(Modular)((Modular)a.raw + (Modular)b.raw));
+  }
+  friend inline gbj_appsmooth_q operator-(gbj_appsmooth_q a, gbj_appsmooth_q b)
+  {
+    return fromRaw((T)(Modular)((Modular)a.raw - (Modular)b.raw));
+  }
+  friend inline gbj_appsmooth_q operator-(gbj_appsmooth_q a)
+  {
+    return fromRaw((T)(Modular)(0 - (Modular)a.raw));
+  }
+  // Product rounded to nearest
+  friend inline gbj_appsmooth_q operator*(gbj_appsmooth_q a, gbj_appsmooth_q b)
+  {
+    return fromRaw(
+      (T)(((Wide)a.raw * b.raw + ((Wide)1 << (F - 1))) >> F));
+  }
+  friend inline bool operator==(gbj_appsmooth_q a, gbj_appsmooth_q b)
+  {
+    return a.raw == b.raw;
+  }
+  friend inline bool operator!=(gbj_appsmooth_q a, gbj_appsmooth_q b)
+  {
+    return a.raw != b.raw;
+  }
+  friend inline bool operator<(gbj_appsmooth_q a, gbj_appsmooth_q b)
+  {
+    return a.raw < b.raw;
+  }
+  friend inline bool operator>(gbj_appsmooth_q a, gbj_appsmooth_q b)
+  {
+    return a.raw > b.raw;
+  }
+  friend inline bool operator<=(gbj_appsmooth_q a, gbj_appsmooth_q b)
+  {
+    return a.raw <= b.raw;
+  }
+  friend inline bool operator>=(gbj_appsmooth_q a, gbj_appsmooth_q b)
+  {
+    return a.raw >= b.raw;
+  }
+};
+
+template<typename T, byte F>
+const T gbj_appsmooth_q<T, F>::ONE;
+
+typedef gbj_appsmooth_q<int32_t, 16> gbj_appsmooth_q16_16;
+typedef gbj_appsmooth_q<int16_t, 8> gbj_appsmooth_q8_8;
+
+#if defined(__AVX2__) || defined(__SSE2__)
+template<byte F>
+struct gbj_appsmooth_gate<gbj_appsmooth_q<int32_t, F>>
+  : gbj_appsmooth_gate_epi32<true>
+{};
+#endif
+
+// Valid difference scaled in integer arithmetic rounded to nearest and
+// saturated to the range of the type
+template<typename T, byte F>
+struct gbj_appsmooth_elapse<gbj_appsmooth_q<T, F>>
+{
+  typedef gbj_appsmooth_q<T, F> Q;
+  static inline Q getDifference(Q difference,
+                                float,
+                                unsigned long elapsed,
+                                unsigned long interval)
+  {
+    const T top = (T)((typename Q::Modular)-1 >> 1);
+    uint64_t raw = difference.raw < 0 ? 0 : (uint64_t)difference.raw;
+    raw = (raw * elapsed + interval / 2) / interval;
+    return Q::fromRaw(raw > (uint64_t)top ? top : (T)raw);
+  }
+};
+
+/*
+  Built-in exponential filtering in fixed-point arithmetic
+
+  PARAMETERS:
+  Q - Fixed-point data type of measures.
+    - Data type: gbj_appsmooth_q
+    - Default value: gbj_appsmooth_q16_16
+*/
+template<class Q = gbj_appsmooth_q16_16>
+struct gbj_appsmooth_qexponential
+{
+  Q value;
+  Q factor;
+  // Smoothing after the first sample
+  bool flRun;
+
+  inline gbj_appsmooth_qexponential()
+    : value(Q::fromRaw(0))
+    , factor(Q::fromRaw(Q::ONE / 2))
+    , flRun(false)
+  {
+  }
+
+  /*
+    Set smoothing factor of the measure
+
+    PARAMETERS:
+    factor - Smoothing factor, i.e., weight of a new sample.
+      - Data type: templated
+      - Default value: 0.5
+      - Limited range: 0.0 ~ 1.0
+
+    RETURN: none
+  */
+  inline void setFactor(Q data = Q::fromRaw(Q::ONE / 2))
+  {
+    factor = data < Q::fromRaw(0)
+               ? Q::fromRaw(0)
+               : (data > Q::fromRaw(Q::ONE) ? Q::fromRaw(Q::ONE) : data);
+  }
+  inline Q getFactor() { return factor; }
+
+  // Same getters as the generic library has
+  inline Q getValue() { return value; }
+  inline Q getValue(Q data)
+  {
+    value = flRun ? value + factor * (data - value) : data;
+    flRun = true;
+    return value;
+  }
+};
+
+template<class Q>
+struct gbj_appsmooth_kernel<gbj_appsmooth_qexponential<Q>, Q>
+{
+  typedef gbj_appsmooth_qexponential<Q> SMT;
+  static inline Q getValue(SMT &smoother) { return smoother.getValue(); }
+  static inline Q getValue(SMT &smoother, Q data)
+  {
+    return smoother.getValue(data);
+  }
+  // Timestamps are not taken into account without floating point
+  static inline Q getValue(SMT &smoother, Q data, float)
+  {
+    return smoother.getValue(data);
+  }
+  // Branchless update of measures up to the highest flagged one
+  static inline void getValues(SMT *smoother,
+                               const Q *data,
+                               Q *output,
+                               byte mask)
+  {
+    for (byte k = 0; k < 8 && (mask >> k); k++)
+    {
+      bool flAccept = (mask >> k) & 1;
+      Q value = smoother[k].value;
+      Q smooth = smoother[k].flRun
+                   ? value + smoother[k].factor * (data[k] - value)
+                   : data[k];
+      smoother[k].value = flAccept ? smooth : value;
+      smoother[k].flRun |= flAccept;
+      output[k] = flAccept ? smooth : output[k];
+    }
+  }
+  static inline Q getBatch(SMT &smoother, const Q *data, byte count)
+  {
+    Q value = smoother.flRun ? smoother.value : data[0];
+    for (byte k = 0; k < count; k++)
+    {
+      value = value + smoother.factor * (data[k] - value);
+    }
+    smoother.value = value;
+    smoother.flRun = true;
+    return value;
+  }
+};
+
+#endif
@@ -0,0 +1,167 @@
+/*
+  NAME:
+  gbj_appsmooth_queue
+
+  DESCRIPTION:
+  Bounded lock-free queue of samples for the application library
+  gbj_appsmooth between one producer and one consumer.
+  - The producer is usually an interrupt service routine or an acquisition
+    thread, which pushes samples of measures.
+  - The consumer is usually the main loop or a smoothing thread, which drains
+    queued samples in batches by the method drain() of the application
+    library.
+  - Positions of the queue are updated by atomic operations, so that neither
+    side ever waits for the other one. On AVR platforms positions are bytes,
+    which are accessed atomically.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_appsmooth.git
+*/
+#ifndef GBJ_APPSMOOTH_QUEUE_H
+#define GBJ_APPSMOOTH_QUEUE_H
+
+#include "gbj_appsmooth.h"
+
+/*
+  PARAMETERS:
+  DAT - Data type of sample values.
+    - Data type: arithmetic type
+    - Default value: float
+  IDX - Data type of measure indices.
+    - Data type: unsigned integer type
+    - Default value: byte
+  CAP - Capacity of the queue in samples.
+    - Data type: positive integer
+    - Default value: 16
+    - Limited range: power of 2 (up to 128 on AVR platforms)
+*/
+template<typename DAT = float, typename IDX = byte, unsigned int CAP = 16>
+class gbj_appsmooth_queue
+{
+  static_assert(CAP && !(CAP & (CAP - 1)), "Capacity should be power of 2");
+#if defined(__AVR__)
+  static_assert(CAP <= 128, "Capacity should fit byte positions");
+  typedef volatile byte Position;
+#else
+  typedef std::atomic<unsigned int> Position;
+#endif
+
+public:
+  struct Sample
+  {
+    DAT value;
+    unsigned long timestamp;
+    IDX idx;
+  };
+
+  inline gbj_appsmooth_queue()
+    : head_(0)
+    , tail_(0)
+  {
+  }
+
+  /*
+    Put a sample to the queue by the producer
+
+    PARAMETERS:
+    value - Sample value.
+      - Data type: templated
+    idx - Index of a measure the sample belongs to.
+      - Data type: templated
+    timestamp - Time of acquisition of the sample, usually in milliseconds.
+      - Data type: non-negative integer
+      - Default value: 0
+
+    RETURN: Flag determining whether the sample has been queued or the queue
+    is full.
+  */
+  inline bool push(DAT value, IDX idx, unsigned long timestamp = 0)
+  {
+    unsigned int head = load(head_, false);
+    if ((Position_t)(head - load(tail_, true)) >= CAP)
+    {
+      return false;
+    }
+    Sample &sample = samples_[head & (CAP - 1)];
+    sample.value = value;
+    sample.timestamp = timestamp;
+    sample.idx = idx;
+    store(head_, head + 1);
+    return true;
+  }
+
+  /*
+    Access queued samples by the consumer
+
+    DESCRIPTION:
+    The consumer gets the number of available samples, reads them in order of
+    arrival, and releases all read samples at once.
+
+    PARAMETERS:
+    order - Order of a sample counting from the oldest one.
+      - Data type: non-negative integer
+      - Limited range: 0 ~ (available - 1)
+    count - Number of read samples to be released.
+      - Data type: non-negative integer
+      - Limited range: 0 ~ available
+  */
+  inline unsigned int available()
+  {
+    return (Position_t)(load(head_, true) - load(tail_, false));
+  }
+  inline const Sample &peek(unsigned int order)
+  {
+    return samples_[(load(tail_, false) + order) & (CAP - 1)];
+  }
+  inline void release(unsigned int count)
+  {
+    store(tail_, load(tail_, false) + count);
+  }
+
+  // Getters
+  inline unsigned int getCapacity() { return CAP; }
+  inline bool isEmpty() { return available() == 0; }
+
+private:
+#if defined(__AVR__)
+  typedef byte Position_t;
+  // Compiler barriers keep sample accesses on proper side of position update
+  static inline unsigned int load(Position &position, bool)
+  {
+    asm volatile("" ::: "memory");
+    return position;
+  }
+  static inline void store(Position &position, unsigned int value)
+  {
+    asm volatile("" ::: "memory");
+    position = value;
+  }
+#else
+  typedef unsigned int Position_t;
+  static inline unsigned int load(Position &position, bool flAcquire)
+  {
+    return position.load(flAcquire ? std::memory_order_acquire
+                                   : std::memory_order_relaxed);
+  }
+  static inline void store(Position &position, unsigned int value)
+  {
+    position.store(value, std::memory_order_release);
+  }
+#endif
+  Sample samples_[CAP];
+  // Positions of the next pushed and the oldest queued sample
+#if defined(__AVR__)
+  Position head_;
+  Position tail_;
+#else
+  alignas(GBJ_APPSMOOTH_CACHE_LINE) Position head_;
+  alignas(GBJ_APPSMOOTH_CACHE_LINE) Position tail_;
+#endif
+};
+
+#endif
@@ -0,0 +1,174 @@
+/*
+  NAME:
+  gbj_appsmooth_replay
+
+  DESCRIPTION:
+  Offline replay of recorded time series of measures through the application
+  library gbj_appsmooth on platforms with file streams, e.g., Linux, for
+  tuning of limits and smoothers with the same code as the embedded one.
+  - A recorded file contains frames of samples with a column per measure.
+    Frames are smoothed by the method setValues() of an instance object
+    initiated and configured by the caller, so that results are identical
+    with the embedded build with the same template parameters.
+  - Binary files are streamed in chunks of many frames with just one read and
+    one write call per chunk. A binary input frame is a packed array of
+    samples of the data type of the instance object. An output frame is
+    a packed array of smoothed values followed by the bitmask of validity
+    flags of the method setValues() with cleared padding bits.
+  - CSV files are processed line by line. An output line contains a pair of
+    columns with smoothed value and validity flag per measure. An input line,
+    which does not start with a number, is considered as a header. An empty
+    or missing field is a missing sample, which is not smoothed and is
+    reported as invalid. Empty lines are skipped.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_appsmooth.git
+*/
+#ifndef GBJ_APPSMOOTH_REPLAY_H
+#define GBJ_APPSMOOTH_REPLAY_H
+
+#include "gbj_appsmooth.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <utility>
+
+// Size of a chunk of frames streamed at once
+#ifndef GBJ_APPSMOOTH_REPLAY_CHUNK
+  #define GBJ_APPSMOOTH_REPLAY_CHUNK (1UL << 20)
+#endif
+
+template<class APP>
+struct gbj_appsmooth_replay
+{
+  typedef decltype(std::declval<APP &>().getValue(0)) DAT;
+
+  /*
+    Replay of a recorded file
+
+    PARAMETERS:
+    smooth - Initiated and configured instance object of the application
+    library with the number of measures equal to the number of columns.
+      - Data type: gbj_appsmooth
+    input - Stream of the recorded file opened for reading.
+      - Data type: pointer to FILE
+    output - Stream of the result file opened for writing.
+      - Data type: pointer to FILE
+
+    RETURN: Number of processed frames.
+  */
+  static unsigned long binary(APP &smooth, FILE *input, FILE *output)
+  {
+    size_t measures = smooth.getMeasures();
+    size_t bytes = (measures + 7) >> 3;
+    size_t sizeIn = measures * sizeof(DAT);
+    size_t sizeOut = sizeIn + bytes;
+    size_t chunk = GBJ_APPSMOOTH_REPLAY_CHUNK / sizeOut;
+    chunk = chunk ? chunk : 1;
+    DAT *frames = new DAT[chunk * measures];
+    // Padding bits of validity bitmasks beyond measures stay cleared
+    byte *results = new byte[chunk * sizeOut]();
+    unsigned long count = 0;
+    size_t frame;
+    while ((frame = fread(frames, sizeIn, chunk, input)) > 0)
+    {
+      for (size_t j = 0; j < frame; j++)
+      {
+        byte *result = results + j * sizeOut;
+        smooth.setValues(frames + j * measures, result + sizeIn);
+        for (size_t i = 0; i < measures; i++)
+        {
+          DAT value = smooth.getValue(i);
+          memcpy(result + i * sizeof(DAT), &value, sizeof(DAT));
+        }
+      }
+      fwrite(results, sizeOut, frame, output);
+      count += frame;
+    }
+    delete[] frames;
+    delete[] results;
+    return count;
+  }
+  static unsigned long csv(APP &smooth, FILE *input, FILE *output)
+  {
+    size_t measures = smooth.getMeasures();
+    DAT *frame = new DAT[measures]();
+    byte *present = new byte[measures];
+    byte *valid = new byte[(measures + 7) >> 3]();
+    char *line = NULL;
+    size_t size = 0;
+    unsigned long count = 0;
+    bool flHeader = true;
+    while (getline(&line, &size, input) > 0)
+    {
+      // Parsing
+      size_t fields = 0;
+      char *pos = line;
+      for (size_t i = 0; i < measures; i++)
+      {
+        char *end;
+        double value = strtod(pos, &end);
+        present[i] = end != pos;
+        fields += present[i];
+        frame[i] = present[i] ? (DAT)value : frame[i];
+        while (*end && *end != ',' && *end != ';' && *end != '\n')
+        {
+          end++;
+        }
+        pos = *end == ',' || *end == ';' ? end + 1 : end;
+      }
+      if (flHeader)
+      {
+        flHeader = false;
+        if (!present[0])
+        {
+          for (size_t i = 0; i < measures; i++)
+          {
+            fprintf(output, "%svalue%zu,valid%zu", i ? "," : "", i, i);
+          }
+          fputc('\n', output);
+          continue;
+        }
+      }
+      if (!fields)
+      {
+        continue;
+      }
+      // Smoothing
+      if (fields == measures)
+      {
+        smooth.setValues(frame, valid);
+      }
+      else
+      {
+        for (size_t i = 0; i < measures; i++)
+        {
+          bool flValid = present[i] && smooth.setValue(frame[i], i);
+          valid[i >> 3] = flValid ? valid[i >> 3] | (1 << (i & 7))
+                                  : valid[i >> 3] & ~(1 << (i & 7));
+        }
+      }
+      for (size_t i = 0; i < measures; i++)
+      {
+        fprintf(output,
+                "%s%.9g,%d",
+                i ? "," : "",
+                (double)smooth.getValue(i),
+                (valid[i >> 3] >> (i & 7)) & 1);
+      }
+      fputc('\n', output);
+      count++;
+    }
+    free(line);
+    delete[] frame;
+    delete[] present;
+    delete[] valid;
+    return count;
+  }
+};
+
+#endif
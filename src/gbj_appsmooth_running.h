@@ -0,0 +1,296 @@
+/*
+  NAME:
+  gbj_appsmooth_running
+
+  DESCRIPTION:
+  Built-in running statistics for the application library gbj_appsmooth.
+  - The smoother is a compact state of a measure with the window of recent
+    samples, so that the window of all measures is one contiguous arena in the
+    structure of arrays layout.
+  - The sum of samples in the window is updated incrementally and recalculated
+    once per window turn in order to avoid accumulation of rounding errors.
+  - Slots of the ring are split by their samples at the rank of the
+    statistic to a lower part in a max-heap and an upper part in a min-heap,
+    so that the median, minimum, or maximum is read from tops of heaps.
+    Heaps share one array of slot indices without pointers, so that the
+    smoother stays one compact block. A sample is removed and inserted in
+    logarithmic time of the window length.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_appsmooth.git
+*/
+#ifndef GBJ_APPSMOOTH_RUNNING_H
+#define GBJ_APPSMOOTH_RUNNING_H
+
+#include "gbj_appsmooth.h"
+#include <stdint.h>
+
+/*
+  PARAMETERS:
+  W - Number of samples in the running window.
+    - Data type: positive integer
+    - Default value: 5
+    - Limited range: 1 ~ maximal unsigned integer
+  T - Data type of samples in the window.
+    - Data type: arithmetic type
+    - Default value: float
+*/
+template<unsigned int W = 5, typename T = float>
+struct gbj_appsmooth_running
+{
+  typedef typename gbj_appsmooth_index<(W > 255)>::type CNT;
+  enum Statistics
+  {
+    AVERAGE,
+    MEDIAN,
+    MINIMUM,
+    MAXIMUM,
+  };
+  static const CNT SAMPLES = W;
+
+  // Samples in order of arrival
+  T ring[W];
+  // Slots of the lower part in a max-heap from the front and of the upper
+  // part in a min-heap from the back of the array
+  CNT heap[W];
+  // Positions of slots in the array of heaps
+  CNT position[W];
+  double sum;
+  CNT items;
+  CNT head;
+  CNT lower;
+  CNT upper;
+  byte statistic;
+
+  inline gbj_appsmooth_running()
+    : sum(0.0)
+    , items(0)
+    , head(0)
+    , lower(0)
+    , upper(0)
+    , statistic(AVERAGE)
+  {
+  }
+
+  // Setters of the calculated statistic
+  inline void setAverage() { setStatistic(AVERAGE); }
+  inline void setMedian() { setStatistic(MEDIAN); }
+  inline void setMinimum() { setStatistic(MINIMUM); }
+  inline void setMaximum() { setStatistic(MAXIMUM); }
+
+  // Getters
+  inline CNT getItems() { return items; }
+  inline float getValue()
+  {
+    if (items == 0)
+    {
+      return 0.0;
+    }
+    switch (statistic)
+    {
+      case MEDIAN:
+        return items % 2
+                 ? ring[heap[0]]
+                 : ((float)ring[heap[0]] + (float)ring[heap[W - 1]]) / 2.0;
+      case MINIMUM:
+      case MAXIMUM:
+        return ring[heap[0]];
+      default:
+        return sum / items;
+    }
+  }
+  inline float getValue(T data)
+  {
+    if (items == W)
+    {
+      // Remove the oldest sample from its heap
+      CNT pos = position[head];
+      bool flUpper = pos >= lower;
+      remove(flUpper, flUpper ? W - 1 - pos : pos);
+      sum -= ring[head];
+      items--;
+      balance();
+    }
+    // Insert new sample to the heap of its part
+    ring[head] = data;
+    push(lower && ring[heap[0]] < data, head);
+    sum += data;
+    items++;
+    balance();
+    if (++head == W)
+    {
+      head = 0;
+      sum = 0.0;
+      for (CNT i = 0; i < W; i++)
+      {
+        sum += ring[i];
+      }
+    }
+    return getValue();
+  }
+
+  // Empty window
+  inline void reset()
+  {
+    items = head = lower = upper = 0;
+    sum = 0.0;
+  }
+
+private:
+  inline void setStatistic(byte data)
+  {
+    statistic = data;
+    balance();
+  }
+  // Size of the lower part with the statistic on the top of its heap
+  inline CNT getLower()
+  {
+    switch (statistic)
+    {
+      case MINIMUM:
+        return items ? 1 : 0;
+      case MAXIMUM:
+        return items;
+      default:
+        return (items + 1) / 2;
+    }
+  }
+  // Moving of tops between heaps until the lower part has its size
+  inline void balance()
+  {
+    CNT target = getLower();
+    while (lower != target)
+    {
+      bool flUpper = lower < target;
+      CNT slot = heap[flUpper ? W - 1 : 0];
+      remove(flUpper, 0);
+      push(!flUpper, slot);
+    }
+  }
+  // Order of slots in the max-heap of the lower or min-heap of the upper part
+  inline bool above(bool flUpper, CNT a, CNT b)
+  {
+    return flUpper ? ring[a] < ring[b] : ring[b] < ring[a];
+  }
+  inline void place(bool flUpper, CNT order, CNT slot)
+  {
+    CNT pos = flUpper ? W - 1 - order : order;
+    heap[pos] = slot;
+    position[slot] = pos;
+  }
+  inline CNT at(bool flUpper, CNT order)
+  {
+    return heap[flUpper ? W - 1 - order : order];
+  }
+  inline void siftUp(bool flUpper, CNT order, CNT slot)
+  {
+    while (order > 0)
+    {
+      CNT parent = (order - 1) / 2;
+      if (!above(flUpper, slot, at(flUpper, parent)))
+      {
+        break;
+      }
+      place(flUpper, order, at(flUpper, parent));
+      order = parent;
+    }
+    place(flUpper, order, slot);
+  }
+  inline void siftDown(bool flUpper, CNT order, CNT slot)
+  {
+    CNT count = flUpper ? upper : lower;
+    for (;;)
+    {
+      // Child index in wider type, because it exceeds the window length
+      unsigned long child = 2UL * order + 1;
+      if (child >= count)
+      {
+        break;
+      }
+      if (child + 1 < count &&
+          above(flUpper, at(flUpper, child + 1), at(flUpper, child)))
+      {
+        child++;
+      }
+      if (!above(flUpper, at(flUpper, child), slot))
+      {
+        break;
+      }
+      place(flUpper, order, at(flUpper, child));
+      order = child;
+    }
+    place(flUpper, order, slot);
+  }
+  inline void push(bool flUpper, CNT slot)
+  {
+    CNT order = flUpper ? upper++ : lower++;
+    siftUp(flUpper, order, slot);
+  }
+  // Removal of the slot at the order of a heap replaced with its last slot
+  inline void remove(bool flUpper, CNT order)
+  {
+    CNT count = flUpper ? --upper : --lower;
+    if (order < count)
+    {
+      CNT slot = at(flUpper, count);
+      siftUp(flUpper, order, slot);
+      CNT pos = position[slot];
+      siftDown(flUpper, flUpper ? W - 1 - pos : pos, slot);
+    }
+  }
+};
+
+template<unsigned int W, typename T>
+const typename gbj_appsmooth_running<W, T>::CNT
+  gbj_appsmooth_running<W, T>::SAMPLES;
+
+template<unsigned int W, typename T, typename DAT>
+struct gbj_appsmooth_kernel<gbj_appsmooth_running<W, T>, DAT>
+{
+  typedef gbj_appsmooth_running<W, T> SMT;
+  static inline DAT getValue(SMT &smoother) { return (DAT)smoother.getValue(); }
+  static inline DAT getValue(SMT &smoother, DAT data)
+  {
+    return (DAT)smoother.getValue((T)data);
+  }
+  static inline DAT getValue(SMT &smoother, DAT data, float)
+  {
+    return getValue(smoother, data);
+  }
+  static inline void getValues(SMT *smoother,
+                               const DAT *data,
+                               DAT *output,
+                               byte mask)
+  {
+    for (byte k = 0; mask; k++, mask >>= 1)
+    {
+      if (mask & 1)
+      {
+        output[k] = getValue(smoother[k], data[k]);
+      }
+    }
+  }
+  // Samples of a batch older than the window are skipped and the full window
+  // is filled from scratch without removals
+  static inline DAT getBatch(SMT &smoother, const DAT *data, byte count)
+  {
+    unsigned int n = count < W ? count : W;
+    if (n == W)
+    {
+      data += count - n;
+      smoother.reset();
+    }
+    for (unsigned int k = 0; k < n; k++)
+    {
+      smoother.getValue((T)data[k]);
+    }
+    return (DAT)smoother.getValue();
+  }
+};
+
+#endif
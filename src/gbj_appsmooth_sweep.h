@@ -0,0 +1,196 @@
+/*
+  NAME:
+  gbj_appsmooth_sweep
+
+  DESCRIPTION:
+  Parameter sweep of the application library gbj_appsmooth for tuning of
+  smoothing factors and limits of a measure in one pass over recorded data.
+  - Each configuration of a measure is a measure of the application library
+    in the structure of arrays layout, so that all configurations are placed
+    side by side in contiguous arrays. Each configuration is set up by common
+    setters and the pointer to its smoother.
+  - Each input value is broadcast to all configurations and processed by the
+    method setValues(), which checks and smooths all configurations in one
+    pass with SIMD instructions, where available.
+  - Statistics of each configuration are accumulated in contiguous arrays as
+    well: number of rejected samples, sum of squared errors, and maximal
+    absolute error of the smoothed value against the reference value, which
+    is the input value itself or a true value provided along with it.
+
+  LICENSE:
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the MIT License (MIT).
+
+  CREDENTIALS:
+  Author: Libor Gabaj
+  GitHub: https://github.com/mrkaleArduinoLib/gbj_appsmooth.git
+*/
+#ifndef GBJ_APPSMOOTH_SWEEP_H
+#define GBJ_APPSMOOTH_SWEEP_H
+
+#include "gbj_appsmooth.h"
+#include <math.h>
+
+template<class SMT, typename DAT = float, typename IDX = unsigned int>
+class gbj_appsmooth_sweep
+  : public gbj_appsmooth<SMT, DAT, gbj_appsmooth_soa, IDX>
+{
+  typedef gbj_appsmooth<SMT, DAT, gbj_appsmooth_soa, IDX> Base;
+
+public:
+  inline gbj_appsmooth_sweep() {}
+  inline ~gbj_appsmooth_sweep() { release(); }
+  // Statistics are transferred by a move, while a copy is not supported
+  gbj_appsmooth_sweep(const gbj_appsmooth_sweep &) = delete;
+  gbj_appsmooth_sweep &operator=(const gbj_appsmooth_sweep &) = delete;
+  inline gbj_appsmooth_sweep(gbj_appsmooth_sweep &&other)
+    : Base(static_cast<Base &&>(other))
+  {
+    take(other);
+  }
+  inline gbj_appsmooth_sweep &operator=(gbj_appsmooth_sweep &&other)
+  {
+    if (this != &other)
+    {
+      Base::operator=(static_cast<Base &&>(other));
+      release();
+      take(other);
+    }
+    return *this;
+  }
+
+  /*
+    Initialization
+
+    PARAMETERS:
+    configs - Number of configurations of a measure.
+      - Data type: positive integer of templated index type
+      - Default value: 1
+      - Limited range: 1 ~ maximum of index type
+
+    RETURN: none
+  */
+  inline void begin(IDX configs = 1)
+  {
+    Base::begin(configs);
+    release();
+    configs = Base::getMeasures();
+    frame_ = new DAT[configs];
+    valid_ = new byte[(configs + 7) >> 3];
+    rejected_ = new unsigned long[configs];
+    errorSum_ = new double[configs];
+    errorMax_ = new double[configs];
+    resetStats();
+  }
+
+  /*
+    Process an input value by all configurations
+
+    PARAMETERS:
+    data - Input value.
+      - Data type: templated
+    reference - True value for evaluation of errors.
+      - Data type: templated
+      - Default value: input value
+
+    RETURN: Number of configurations, which have accepted the input value.
+  */
+  inline IDX setValue(DAT data) { return setValue(data, data); }
+  IDX setValue(DAT data, DAT reference)
+  {
+    IDX configs = Base::getMeasures();
+    for (IDX k = 0; k < configs; k++)
+    {
+      frame_[k] = data;
+    }
+    IDX accepted = Base::setValues(frame_, valid_);
+    for (IDX k = 0; k < configs; k++)
+    {
+      double error = fabs((double)(Base::getValue(k) - reference));
+      rejected_[k] += !((valid_[k >> 3] >> (k & 7)) & 1);
+      errorSum_[k] += error * error;
+      errorMax_[k] = error > errorMax_[k] ? error : errorMax_[k];
+    }
+    samples_++;
+    return accepted;
+  }
+
+  /*
+    Statistics of configurations
+
+    DESCRIPTION:
+    The getters return statistics of a configuration since the initialization
+    or recent reset of statistics.
+    - The method getBest() returns the configuration with the least root mean
+      square error.
+
+    PARAMETERS:
+    idx - Index of a configuration.
+      - Data type: non-negative integer
+      - Limited range: 0 ~ (configs - 1)
+  */
+  inline void resetStats()
+  {
+    samples_ = 0;
+    for (IDX k = 0; k < Base::getMeasures(); k++)
+    {
+      rejected_[k] = 0;
+      errorSum_[k] = errorMax_[k] = 0.0;
+    }
+  }
+  inline unsigned long getSamples() { return samples_; }
+  inline unsigned long getRejected(IDX idx) { return rejected_[idx]; }
+  inline double getError(IDX idx)
+  {
+    return samples_ ? sqrt(errorSum_[idx] / samples_) : 0.0;
+  }
+  inline double getErrorMax(IDX idx) { return errorMax_[idx]; }
+  inline IDX getBest()
+  {
+    IDX best = 0;
+    for (IDX k = 1; k < Base::getMeasures(); k++)
+    {
+      best = errorSum_[k] < errorSum_[best] ? k : best;
+    }
+    return best;
+  }
+
+private:
+  inline void release()
+  {
+    delete[] frame_;
+    delete[] valid_;
+    delete[] rejected_;
+    delete[] errorSum_;
+    delete[] errorMax_;
+    frame_ = NULL;
+    valid_ = NULL;
+    rejected_ = NULL;
+    errorSum_ = errorMax_ = NULL;
+  }
+  inline void take(gbj_appsmooth_sweep &other)
+  {
+    frame_ = other.frame_;
+    valid_ = other.valid_;
+    samples_ = other.samples_;
+    rejected_ = other.rejected_;
+    errorSum_ = other.errorSum_;
+    errorMax_ = other.errorMax_;
+    other.frame_ = NULL;
+    other.valid_ = NULL;
+    other.samples_ = 0;
+    other.rejected_ = NULL;
+    other.errorSum_ = other.errorMax_ = NULL;
+  }
+
+  // Broadcast frame of input value and acceptance flags
+  DAT *frame_ = NULL;
+  byte *valid_ = NULL;
+  // Statistics of configurations
+  unsigned long samples_ = 0;
+  unsigned long *rejected_ = NULL;
+  double *errorSum_ = NULL;
+  double *errorMax_ = NULL;
+};
+
+#endif